@@ -0,0 +1,140 @@
+//============================================================================
+// Name        : BidHash.hpp
+// Author      : Joshua Hale
+// Version     : 1.0
+// Description : Hash functions the hash table can be built with
+//============================================================================
+
+#ifndef BIDHASH_HPP
+#define BIDHASH_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+/**
+ * A hash policy hashes id strings with Bytes and numeric ids with Word,
+ * both to 64 bits. BidKeyTraits picks which one a key uses and folds
+ * the result to the 32 bits the table stores.
+ */
+
+/**
+ * The table's original hash: a byte at a time, multiplying by 31, with
+ * Fibonacci hashing for numeric ids. Kept to compare against.
+ */
+struct MultiplyHash {
+    uint64_t seed;
+
+    MultiplyHash(uint64_t aSeed = 0) {
+        seed = aSeed;
+    }
+
+    uint64_t Bytes(std::string_view key) const {
+        unsigned int hashValue = static_cast<unsigned int>(seed);
+        for (char ch : key) {
+            hashValue = (hashValue * 31) + ch;
+        }
+        return hashValue;
+    }
+
+    uint64_t Word(uint64_t value) const {
+        return ((value ^ seed) * 0x9E3779B97F4A7C15ULL) >> 32;
+    }
+};
+
+/**
+ * A hash in the style of wyhash: reads the key 8 bytes at a time and
+ * mixes with full 64x64 to 128 bit multiplies, so every input bit
+ * reaches every output bit. Different seeds give unrelated hashes.
+ */
+struct WyHash {
+    static const uint64_t P0 = 0xa0761d6478bd642fULL;
+    static const uint64_t P1 = 0xe7037ed1a0b428dbULL;
+
+    uint64_t seed;
+
+    WyHash(uint64_t aSeed = 0) {
+        seed = aSeed ^ mix(aSeed ^ P0, P1);
+    }
+
+    /**
+     * Both halves of the 128 bit product of a and b, xored together
+     */
+    static uint64_t mix(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+        unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+        return static_cast<uint64_t>(product) ^ static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+        uint64_t high;
+        uint64_t low = _umul128(a, b, &high);
+        return low ^ high;
+#else
+        uint64_t aHigh = a >> 32, aLow = uint32_t(a), bHigh = b >> 32, bLow = uint32_t(b);
+        uint64_t highHigh = aHigh * bHigh, highLow = aHigh * bLow;
+        uint64_t lowHigh = aLow * bHigh, lowLow = aLow * bLow;
+        uint64_t middle = (lowLow >> 32) + uint32_t(highLow) + uint32_t(lowHigh);
+        uint64_t low = (middle << 32) | uint32_t(lowLow);
+        uint64_t high = highHigh + (highLow >> 32) + (lowHigh >> 32) + (middle >> 32);
+        return low ^ high;
+#endif
+    }
+
+    static uint64_t read64(const char* bytes) {
+        uint64_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    static uint64_t read32(const char* bytes) {
+        uint32_t value;
+        std::memcpy(&value, bytes, sizeof(value));
+        return value;
+    }
+
+    uint64_t Bytes(std::string_view key) const {
+        const char* bytes = key.data();
+        size_t length = key.size();
+        uint64_t state = seed;
+        uint64_t a, b;
+
+        if (length <= 16) {
+            if (length >= 4) {
+                // two overlapping reads from each end cover 4 to 16 bytes
+                size_t offset = (length >> 3) << 2;
+                a = (read32(bytes) << 32) | read32(bytes + offset);
+                b = (read32(bytes + length - 4) << 32) | read32(bytes + length - 4 - offset);
+            }
+            else if (length > 0) {
+                a = (uint64_t(uint8_t(bytes[0])) << 16) | (uint64_t(uint8_t(bytes[length >> 1])) << 8)
+                    | uint8_t(bytes[length - 1]);
+                b = 0;
+            }
+            else {
+                a = 0;
+                b = 0;
+            }
+        }
+        else {
+            size_t remaining = length;
+            while (remaining > 16) {
+                state = mix(read64(bytes) ^ P1, read64(bytes + 8) ^ state);
+                bytes += 16;
+                remaining -= 16;
+            }
+            a = read64(bytes + remaining - 16);
+            b = read64(bytes + remaining - 8);
+        }
+
+        return mix(P1 ^ length, mix(a ^ P1, b ^ state));
+    }
+
+    uint64_t Word(uint64_t value) const {
+        return mix(value ^ P0, seed ^ P1);
+    }
+};
+
+#endif // BIDHASH_HPP
@@ -0,0 +1,135 @@
+//============================================================================
+// Name        : BidKey.hpp
+// Author      : Joshua Hale
+// Version     : 1.0
+// Description : Key types the bid containers can be keyed on
+//============================================================================
+
+#ifndef BIDKEY_HPP
+#define BIDKEY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * Describes how a container compares and hashes bid ids for a given
+ * key type. A container node derives from Cached, which holds whatever
+ * the key type keeps next to the bid, and comparisons run on Probes
+ * built either from a node or from an id being looked up. Hashing runs
+ * through a hash policy, see BidHash.hpp.
+ */
+template <typename Key>
+struct BidKeyTraits;
+
+/**
+ * Ids compared as strings, the default. Nothing is cached in the
+ * node, comparisons read the id held by the bid itself.
+ */
+template <>
+struct BidKeyTraits<std::string> {
+    typedef std::string_view Probe;
+
+    struct Cached {
+        void Cache(std::string_view) {
+        }
+    };
+
+    static Probe MakeProbe(std::string_view bidId) {
+        return bidId;
+    }
+
+    template <typename Node>
+    static Probe ProbeOf(const Node& node) {
+        return node.bid.bidId;
+    }
+
+    static bool Less(Probe a, Probe b) {
+        return a < b;
+    }
+
+    static bool Equal(Probe a, Probe b) {
+        return a == b;
+    }
+
+    template <typename Hasher>
+    static unsigned int Hash(Probe probe, const Hasher& hasher) {
+        uint64_t hashValue = hasher.Bytes(probe);
+        return static_cast<unsigned int>(hashValue ^ (hashValue >> 32));
+    }
+};
+
+/**
+ * Numeric ids compared as integers. The id is parsed once when a bid
+ * is stored and kept next to it, so comparisons and hashing are single
+ * integer operations. Ids that are not canonical decimal numbers (empty,
+ * leading zeros, other characters, more than 18 digits) are marked with
+ * the top bit and fall back to comparing the strings; they sort after
+ * every numeric id.
+ */
+template <>
+struct BidKeyTraits<uint64_t> {
+    static const uint64_t FALLBACK = uint64_t(1) << 63;
+
+    struct Probe {
+        uint64_t value;
+        std::string_view bidId;
+    };
+
+    struct Cached {
+        uint64_t cachedKey = FALLBACK;
+
+        void Cache(std::string_view bidId) {
+            cachedKey = Parse(bidId);
+        }
+    };
+
+    /**
+     * Integer value of an id, or FALLBACK when it is not numeric
+     */
+    static uint64_t Parse(std::string_view bidId) {
+        if (bidId.empty() || bidId.size() > 18 || (bidId[0] == '0' && bidId.size() > 1)) {
+            return FALLBACK;
+        }
+        uint64_t value = 0;
+        for (char ch : bidId) {
+            if (ch < '0' || ch > '9') {
+                return FALLBACK;
+            }
+            value = value * 10 + (ch - '0');
+        }
+        return value;
+    }
+
+    static Probe MakeProbe(std::string_view bidId) {
+        return Probe{ Parse(bidId), bidId };
+    }
+
+    template <typename Node>
+    static Probe ProbeOf(const Node& node) {
+        return Probe{ node.cachedKey, node.bid.bidId };
+    }
+
+    static bool Less(const Probe& a, const Probe& b) {
+        if (a.value & b.value & FALLBACK) {
+            return a.bidId < b.bidId;
+        }
+        return a.value < b.value;
+    }
+
+    static bool Equal(const Probe& a, const Probe& b) {
+        return a.value == b.value && (!(a.value & FALLBACK) || a.bidId == b.bidId);
+    }
+
+    template <typename Hasher>
+    static unsigned int Hash(const Probe& probe, const Hasher& hasher) {
+        if (probe.value & FALLBACK) {
+            return BidKeyTraits<std::string>::Hash(probe.bidId, hasher);
+        }
+        uint64_t hashValue = hasher.Word(probe.value);
+        return static_cast<unsigned int>(hashValue ^ (hashValue >> 32));
+    }
+};
+
+#endif // BIDKEY_HPP
@@ -0,0 +1,503 @@
+//============================================================================
+// Name        : BidLog.hpp
+// Author      : Joshua Hale
+// Version     : 1.0
+// Description : Append-only log of bid inserts and removes
+//============================================================================
+
+#ifndef BIDLOG_HPP
+#define BIDLOG_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include "BidHash.hpp"
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// change log statistics
+struct BidLogStats {
+    unsigned long long records = 0; // changes appended
+    unsigned long long syncs = 0;   // flushes to the disk
+    size_t bytes = 0;               // log size since the last checkpoint
+};
+
+/**
+ * Records every Insert and Remove of a container so its state can be
+ * rebuilt from the last snapshot file without the source data.
+ *
+ * Each record is its payload length, a checksum of the payload, then
+ * the payload: sequence number, operation and the bid's fields.
+ * Replay stops at the first record that is cut short or fails its
+ * checksum, which is where a crash interrupted the last write.
+ *
+ * Changes are appended to memory and a background thread writes and
+ * syncs them in groups every few milliseconds, so one fsync covers
+ * every change made meanwhile and Insert and Remove never wait for
+ * the disk. A crash loses at most the last group; Sync waits until
+ * everything appended so far is on disk. A group the thread cannot
+ * write stays pending and is retried, and Check reports the failure.
+ * With a group time of 0 each change is synced before it returns
+ * instead.
+ *
+ * A checkpoint saves a snapshot that includes every change up to
+ * Sequence and then calls Reset to empty the log.
+ */
+class BidLog {
+
+public:
+    enum Operation : uint8_t { INSERT = 1, REMOVE = 2 };
+
+private:
+    static const uint64_t SEED = 0x424c4f47ULL;
+
+    // length and checksum in front of every payload
+    static const size_t RECORD_HEADER = 8;
+
+    std::string path;
+    int file;
+    unsigned int groupMillis;
+    size_t checkpointBytes;
+
+    mutable std::mutex lock;
+    std::condition_variable wake;    // tells the writer to stop
+    std::condition_variable flushed; // a group finished writing
+    std::string pending;             // records not written yet
+    uint64_t sequence;               // last record appended
+    uint64_t writtenSequence;        // last record written, maybe not synced
+    uint64_t syncedSequence;         // last record on disk
+    size_t fileBytes;                // file size through writtenSequence
+    bool torn;                       // a failed write left part of a group
+    bool writing;
+    bool stopping;
+    std::string failure;             // writer error not reported yet
+    BidLogStats stats;
+    std::thread writer;
+
+    static uint32_t checksum(std::string_view payload) {
+        return static_cast<uint32_t>(WyHash(SEED).Bytes(payload));
+    }
+
+    static void putWord(std::string& out, uint32_t value) {
+        out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    static void putString(std::string& out, std::string_view value) {
+        putWord(out, static_cast<uint32_t>(value.size()));
+        out.append(value.data(), value.size());
+    }
+
+    template <typename Value>
+    static bool get(std::string_view& in, Value& value) {
+        if (in.size() < sizeof(Value)) {
+            return false;
+        }
+        std::memcpy(&value, in.data(), sizeof(Value));
+        in.remove_prefix(sizeof(Value));
+        return true;
+    }
+
+    static bool getString(std::string_view& in, std::string& value) {
+        uint32_t size;
+        if (!get(in, size) || in.size() < size) {
+            return false;
+        }
+        value.assign(in.data(), size);
+        in.remove_prefix(size);
+        return true;
+    }
+
+    void fail(const char* reason) const {
+        throw std::runtime_error("change log " + path + ": " + reason);
+    }
+
+    bool writeAll(const std::string& bytes) {
+        for (size_t done = 0; done < bytes.size();) {
+#if defined(_WIN32)
+            int count = _write(file, bytes.data() + done,
+                static_cast<unsigned int>(std::min<size_t>(bytes.size() - done, 1 << 30)));
+#else
+            ssize_t count = write(file, bytes.data() + done, bytes.size() - done);
+#endif
+            if (count <= 0) {
+                return false;
+            }
+            done += static_cast<size_t>(count);
+        }
+        return true;
+    }
+
+    bool syncFile() {
+#if defined(_WIN32)
+        return _commit(file) == 0;
+#else
+        return fsync(file) == 0;
+#endif
+    }
+
+    bool truncateFile(size_t size) {
+#if defined(_WIN32)
+        return _chsize_s(file, static_cast<long long>(size)) == 0;
+#else
+        return ftruncate(file, static_cast<off_t>(size)) == 0;
+#endif
+    }
+
+    /**
+     * Append a record for the next sequence number
+     *
+     * When each change is synced on its own and that fails, the record
+     * is taken back out before the error is thrown, so a change the
+     * caller did not apply is never replayed.
+     */
+    uint64_t append(Operation operation, const std::string& fields) {
+        std::string payload;
+        payload.reserve(sizeof(uint64_t) + 1 + fields.size());
+
+        std::unique_lock<std::mutex> guard(lock);
+        uint64_t number = ++sequence;
+        payload.append(reinterpret_cast<const char*>(&number), sizeof(number));
+        payload += static_cast<char>(operation);
+        payload += fields;
+
+        putWord(pending, static_cast<uint32_t>(payload.size()));
+        putWord(pending, checksum(payload));
+        pending += payload;
+        size_t recordBytes = RECORD_HEADER + payload.size();
+        stats.bytes += recordBytes;
+        ++stats.records;
+
+        if (groupMillis == 0) {
+            try {
+                flush(guard);
+            }
+            catch (std::runtime_error&) {
+                // the record is the whole group, earlier ones were taken
+                // back the same way
+                if (writtenSequence == number) {
+                    // written but not synced, cut it off the file
+                    fileBytes -= recordBytes;
+                    writtenSequence = number - 1;
+                    torn = !truncateFile(fileBytes);
+                }
+                else {
+                    pending.resize(pending.size() - recordBytes);
+                }
+                sequence = number - 1;
+                stats.bytes -= recordBytes;
+                --stats.records;
+                throw;
+            }
+        }
+        return number;
+    }
+
+    /**
+     * Write and sync everything pending, with the lock held on entry
+     * and exit but not while waiting on the disk
+     *
+     * A write that fails partway is cut off the file again before the
+     * group is retried, so a torn record never ends up in front of
+     * good ones where Replay would stop at it. When only the sync
+     * fails the group stays written and the next attempt just syncs.
+     */
+    void flush(std::unique_lock<std::mutex>& guard) {
+        flushed.wait(guard, [this] { return !writing; });
+        if (pending.empty() && syncedSequence == writtenSequence) {
+            return;
+        }
+
+        std::string group;
+        group.swap(pending);
+        uint64_t last = sequence;
+        writing = true;
+        guard.unlock();
+        // only this thread touches the file while writing is set
+        bool written = true;
+        if (!group.empty()) {
+            if (torn) {
+                torn = !truncateFile(fileBytes);
+            }
+            written = !torn && writeAll(group);
+            if (!written) {
+                torn = !truncateFile(fileBytes);
+            }
+        }
+        bool synced = written && syncFile();
+        guard.lock();
+        writing = false;
+        if (written) {
+            fileBytes += group.size();
+            writtenSequence = last;
+        }
+        else {
+            // keep the group for the next attempt
+            pending.insert(0, group);
+        }
+        if (synced) {
+            syncedSequence = writtenSequence;
+            ++stats.syncs;
+        }
+        flushed.notify_all();
+        if (!synced) {
+            fail(written ? "cannot sync" : "cannot write");
+        }
+    }
+
+    void writeGroups() {
+        std::unique_lock<std::mutex> guard(lock);
+        while (!stopping) {
+            wake.wait_for(guard, std::chrono::milliseconds(groupMillis), [this] { return stopping; });
+            try {
+                flush(guard);
+            }
+            catch (std::runtime_error& e) {
+                // the group is retried next time, Check reports the failure
+                failure = e.what();
+            }
+        }
+    }
+
+public:
+    /**
+     * Open a log for appending, creating it when missing. Replay an
+     * existing log and checkpoint before appending, so records follow
+     * on from the right sequence number.
+     *
+     * @param aPath Log file
+     * @param lastSequence Sequence number of the last change already
+     *        applied, from the snapshot or replay
+     * @param aGroupMillis Longest time a change waits to be synced,
+     *        0 syncs every change on its own
+     * @param aCheckpointBytes Log size at which NeedsCheckpoint turns
+     *        true
+     * @throws std::runtime_error when the file cannot be opened
+     */
+    BidLog(const std::string& aPath, uint64_t lastSequence, unsigned int aGroupMillis = 5,
+        size_t aCheckpointBytes = 4 << 20) : path(aPath) {
+        groupMillis = aGroupMillis;
+        checkpointBytes = aCheckpointBytes;
+        sequence = lastSequence;
+        writtenSequence = lastSequence;
+        syncedSequence = lastSequence;
+        torn = false;
+        writing = false;
+        stopping = false;
+
+#if defined(_WIN32)
+        file = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+        file = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+        if (file < 0) {
+            fail("cannot open");
+        }
+#if defined(_WIN32)
+        fileBytes = static_cast<size_t>(_lseeki64(file, 0, SEEK_END));
+#else
+        fileBytes = static_cast<size_t>(lseek(file, 0, SEEK_END));
+#endif
+        stats.bytes = fileBytes;
+
+        if (groupMillis > 0) {
+            writer = std::thread(&BidLog::writeGroups, this);
+        }
+    }
+
+    BidLog(const BidLog&) = delete;
+    BidLog& operator=(const BidLog&) = delete;
+
+    /**
+     * Destructor, syncs the last group. Call Sync first to find out
+     * whether that worked.
+     */
+    ~BidLog() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        if (writer.joinable()) {
+            writer.join();
+        }
+        try {
+            Sync();
+        }
+        catch (std::runtime_error&) {
+            // nothing left to report to
+        }
+#if defined(_WIN32)
+        _close(file);
+#else
+        close(file);
+#endif
+    }
+
+    /**
+     * Log an insert
+     *
+     * @param bid Object with bidId, title, fund and amount members
+     * @return Sequence number of the record
+     */
+    template <typename Bid>
+    uint64_t Insert(const Bid& bid) {
+        std::string fields;
+        putString(fields, bid.bidId);
+        putString(fields, bid.title);
+        putString(fields, bid.fund);
+        fields.append(reinterpret_cast<const char*>(&bid.amount), sizeof(bid.amount));
+        return append(INSERT, fields);
+    }
+
+    /**
+     * Log a remove
+     *
+     * @param bidId Id of the removed bid
+     * @return Sequence number of the record
+     */
+    uint64_t Remove(std::string_view bidId) {
+        std::string fields;
+        putString(fields, bidId);
+        return append(REMOVE, fields);
+    }
+
+    /**
+     * Wait until every change appended so far is on disk
+     *
+     * @throws std::runtime_error when the log cannot be written
+     */
+    void Sync() {
+        std::unique_lock<std::mutex> guard(lock);
+        uint64_t wanted = sequence;
+        while (syncedSequence < wanted) {
+            flush(guard);
+        }
+    }
+
+    /**
+     * Report a failure of the background writer that nothing has
+     * reported yet; the changes it could not write are retried
+     *
+     * @throws std::runtime_error when a group could not be written or
+     *         synced since the last check
+     */
+    void Check() {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!failure.empty()) {
+            std::string reason;
+            reason.swap(failure);
+            throw std::runtime_error(reason);
+        }
+    }
+
+    /**
+     * Empty the log once a snapshot holds every change up to Sequence,
+     * changes must not be appended meanwhile
+     */
+    void Reset() {
+        std::unique_lock<std::mutex> guard(lock);
+        flushed.wait(guard, [this] { return !writing; });
+        pending.clear();
+        if (!truncateFile(0) || !syncFile()) {
+            fail("cannot empty");
+        }
+        writtenSequence = sequence;
+        syncedSequence = sequence;
+        fileBytes = 0;
+        torn = false;
+        failure.clear();
+        stats.bytes = 0;
+    }
+
+    /**
+     * Sequence number of the last change appended
+     */
+    uint64_t Sequence() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return sequence;
+    }
+
+    /**
+     * True once the log has grown enough that a checkpoint should
+     * replace it with a snapshot
+     */
+    bool NeedsCheckpoint() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return stats.bytes >= checkpointBytes;
+    }
+
+    BidLogStats GetStats() const {
+        std::lock_guard<std::mutex> guard(lock);
+        return stats;
+    }
+
+    /**
+     * Apply the changes of a log file that come after a snapshot
+     *
+     * @param logPath Log file, a missing file holds no changes
+     * @param after Sequence number the snapshot includes
+     * @param insert Called with each inserted Bid
+     * @param remove Called with each removed bid id
+     * @return Sequence number of the last change applied, or after
+     *         when there were none
+     */
+    template <typename Bid, typename OnInsert, typename OnRemove>
+    static uint64_t Replay(const std::string& logPath, uint64_t after, OnInsert insert, OnRemove remove) {
+        std::ifstream in(logPath, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        std::string_view rest(bytes);
+
+        uint64_t last = after;
+        uint32_t size, sum;
+        while (get(rest, size) && get(rest, sum) && rest.size() >= size) {
+            std::string_view payload = rest.substr(0, size);
+            if (checksum(payload) != sum) {
+                break;
+            }
+            rest.remove_prefix(size);
+
+            uint64_t number;
+            uint8_t operation;
+            Bid bid;
+            bool parsed = get(payload, number) && get(payload, operation)
+                && getString(payload, bid.bidId);
+            if (parsed && operation == INSERT) {
+                parsed = getString(payload, bid.title) && getString(payload, bid.fund)
+                    && get(payload, bid.amount);
+            }
+            if (!parsed || (operation != INSERT && operation != REMOVE)) {
+                break;
+            }
+            if (number <= after) {
+                continue;
+            }
+
+            if (operation == INSERT) {
+                insert(std::move(bid));
+            }
+            else {
+                remove(std::string_view(bid.bidId));
+            }
+            last = number;
+        }
+        return last;
+    }
+};
+
+#endif // BIDLOG_HPP
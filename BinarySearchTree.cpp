@@ -6,9 +6,30 @@
 // Description : Lab 5-2 Binary Search Tree
 //============================================================================
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <random>
+#include <string_view>
+#include <thread>
 #include <time.h>
+#include "BidKey.hpp"
+#include "BidLog.hpp"
+#include "BloomFilter.hpp"
 #include "CSVparser.hpp"
+#include "MappedBids.hpp"
+#include "NodePool.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
 
 using namespace std;
 
@@ -16,9 +37,30 @@ using namespace std;
 // Global definitions visible to all methods and classes
 //============================================================================
 
+// number of synthetic bids used by the benchmarks
+const unsigned int BENCHMARK_SIZE = 1000000;
+
+// lookups a batch search keeps in flight at once
+const size_t BATCH_LANES = 16;
+
+// fewest ids a rebuilt bloom filter is sized for
+const size_t FILTER_MIN_KEYS = 1024;
+
 // forward declarations
 double strToDouble(string str, char ch);
-//void displayBid(Bid bid);
+//void displayBid(const Bid& bid);
+class BidSnapshot;
+
+/**
+* Hint the processor to start loading a cache line we will need soon
+*/
+inline void prefetch(const void* address) {
+#if defined(_MSC_VER)
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    __builtin_prefetch(address);
+#endif
+}
 
 // define a structure to hold bid information
 struct Bid {
@@ -31,264 +73,3580 @@ struct Bid {
     }
 };
 
-// Internal structure for tree node
-struct Node {
+// Internal structure for tree node, the base caches the bid's key
+template <typename Key>
+struct TreeNode : BidKeyTraits<Key>::Cached {
     Bid bid;
-    Node* left;
-    Node* right;
+    TreeNode* left;
+    TreeNode* right;
+    int height; // height of the subtree rooted here, leaves are 1
+    size_t size; // number of bids in the subtree rooted here
+    double amountSum; // total amount of the bids in the subtree rooted here
 
     // default constructor
-    Node() {
+    TreeNode() {
         left = nullptr;
         right = nullptr;
+        height = 1;
+        size = 1;
+        amountSum = 0.0;
+    }
+
+    // initialize with a bid, taking over its strings
+    TreeNode(Bid aBid) : TreeNode() {
+        bid = move(aBid);
+        amountSum = bid.amount;
+        this->Cache(bid.bidId);
+    }
+};
+
+//============================================================================
+// Binary Search Tree class definition
+//============================================================================
+
+/**
+* Define a class containing data members and methods to
+* implement a binary search tree
+*
+* The tree is kept height balanced (AVL) so that Insert, Remove and
+* Search stay O(log n) even when bids arrive already sorted by id.
+*
+* An optional bloom filter answers most lookups of missing ids
+* without descending the tree. An attached change log records every
+* insert and remove, see BidLog.
+*
+* Key picks how ids are compared, see BidKeyTraits. Bids are kept in
+* the order of their keys, so a numeric tree orders ids by value.
+*/
+template <typename Key>
+class BasicBinarySearchTree {
+
+private:
+    typedef TreeNode<Key> Node;
+    typedef BidKeyTraits<Key> Traits;
+    typedef typename Traits::Probe Probe;
+
+    Node* root;
+    NodePool<Node> nodePool;
+    BloomFilter* filter;
+    BidLog* log; // not owned
+
+    Node* addNode(Node* node, Node* leaf);
+    void inOrder(Node* node);
+    Node* removeNode(Node* node, const Probe& key);
+    Node* removeMin(Node* node, Node*& minNode);
+    Node* buildBalanced(vector<Node*>& nodes, size_t begin, size_t end);
+    void flatten(vector<Node*>& nodes);
+    void rebuildFilter();
+
+    static Probe probeOf(const Node* node);
+    static int height(Node* node);
+    static size_t size(const Node* node);
+    static double amountSum(const Node* node);
+    static void update(Node* node);
+    static Node* rotateLeft(Node* node);
+    static Node* rotateRight(Node* node);
+    static Node* rebalance(Node* node);
+
+public:
+    /**
+    * Forward iterator over the bids in id order
+    *
+    * Holds the path of nodes still to visit, so it is invalidated by
+    * Insert, Remove and BulkLoad.
+    */
+    class Iterator {
+        friend class BasicBinarySearchTree;
+        vector<const Node*> pending;
+
+    public:
+        const Bid& operator*() const { return pending.back()->bid; }
+        const Bid* operator->() const { return &pending.back()->bid; }
+        Iterator& operator++();
+        bool operator==(const Iterator& other) const { return pending == other.pending; }
+        bool operator!=(const Iterator& other) const { return pending != other.pending; }
+    };
+
+    BasicBinarySearchTree();
+    virtual ~BasicBinarySearchTree();
+    void InOrder();
+    Iterator begin() const;
+    Iterator end() const;
+    Iterator LowerBound(string_view bidId) const;
+    Iterator UpperBound(string_view bidId) const;
+    vector<const Bid*> Range(string_view low, string_view high) const;
+    size_t Rank(string_view bidId) const;
+    const Bid* Select(size_t rank) const;
+    size_t CountRange(string_view low, string_view high) const;
+    double SumRange(string_view low, string_view high) const;
+    size_t Size() const;
+    void Insert(const Bid& bid);
+    void Insert(Bid&& bid);
+    void BulkLoad(vector<Bid> bids);
+    void Remove(string_view bidId);
+    const Bid* Find(string_view bidId) const;
+    Bid Search(string_view bidId) const;
+    void SearchBatch(const string_view* bidIds, size_t count, const Bid** found) const;
+    int Height();
+    NodePoolStats AllocatorStats();
+    BidSnapshot* Freeze();
+    void EnableFilter(double bitsPerKey);
+    void DisableFilter();
+    BloomFilterStats FilterStats();
+    void AttachLog(BidLog* aLog);
+};
+
+// Tree keyed on id strings
+typedef BasicBinarySearchTree<string> BinarySearchTree;
+
+// Tree keyed on numeric ids, falling back to strings for other ids
+typedef BasicBinarySearchTree<uint64_t> NumericBinarySearchTree;
+
+/**
+* Default constructor
+*/
+template <typename Key>
+BasicBinarySearchTree<Key>::BasicBinarySearchTree() {
+    // initialize housekeeping variables
+    root = nullptr;
+    filter = nullptr;
+    log = nullptr;
+}
+
+/**
+* Destructor
+*/
+template <typename Key>
+BasicBinarySearchTree<Key>::~BasicBinarySearchTree() {
+    // Destroy every node in a single non-recursive pass: a node with a
+    // left child is rotated right until the left spine is empty, then
+    // it can be destroyed and the walk continues down its right child.
+    // The pool releases the node blocks themselves all at once.
+    Node* node = root;
+    while (node != nullptr) {
+        if (node->left != nullptr) {
+            Node* left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        }
+        else {
+            Node* next = node->right;
+            nodePool.Destroy(node);
+            node = next;
+        }
+    }
+    root = nullptr;
+    delete filter;
+}
+
+/**
+* Traverse the tree in order
+*/
+template <typename Key>
+void BasicBinarySearchTree<Key>::InOrder() {
+    // In order traversal from root
+    inOrder(root);
+}
+
+template <typename Key>
+void BasicBinarySearchTree<Key>::inOrder(Node* node) {
+    //FixMe (3b)
+    if (node != nullptr) {
+        inOrder(node->left);
+        cout << node->bid.bidId << ": " << node->bid.title << " | "
+            << node->bid.amount << " | " << node->bid.fund << endl;
+        inOrder(node->right);
+    }
+}
+
+/**
+* Insert a copy of a bid
+*/
+template <typename Key>
+void BasicBinarySearchTree<Key>::Insert(const Bid& bid) {
+    Insert(Bid(bid));
+}
+
+/**
+* Insert a bid, moving its strings into the tree
+*/
+template <typename Key>
+void BasicBinarySearchTree<Key>::Insert(Bid&& bid) {
+    // logged first, a change the log cannot save throws before it is made
+    if (log != nullptr) {
+        log->Insert(bid);
+    }
+
+    // add Node to the root, the root may change after rebalancing
+    Node* leaf = nodePool.Create(move(bid));
+    root = addNode(root, leaf);
+
+    if (filter != nullptr) {
+        filter->Add(leaf->bid.bidId);
+        if (filter->Stale()) {
+            rebuildFilter();
+        }
+    }
+}
+
+/**
+* Load many bids at once
+*
+* The bids are sorted by id once, merged with any bids already in the
+* tree and linked into a perfectly balanced tree in a single linear
+* pass, instead of paying a rebalancing descent per row.
+*
+* @param bids The bids to add
+*/
+template <typename Key>
+void BasicBinarySearchTree<Key>::BulkLoad(vector<Bid> bids) {
+    if (log != nullptr) {
+        size_t logged = 0;
+        try {
+            for (const Bid& bid : bids) {
+                log->Insert(bid);
+                ++logged;
+            }
+        }
+        catch (runtime_error&) {
+            // load the bids the log saved, so the tree matches a replay
+            bids.resize(logged);
+            BidLog* attached = log;
+            log = nullptr;
+            BulkLoad(move(bids));
+            log = attached;
+            throw;
+        }
+    }
+
+    // sort positions by key, stable so duplicate ids keep their file
+    // order like Insert does
+    vector<pair<Probe, size_t>> order;
+    order.reserve(bids.size());
+    for (size_t i = 0; i < bids.size(); ++i) {
+        order.push_back(make_pair(Traits::MakeProbe(bids[i].bidId), i));
+    }
+    stable_sort(order.begin(), order.end(), [](const pair<Probe, size_t>& a, const pair<Probe, size_t>& b) {
+        return Traits::Less(a.first, b.first);
+    });
+
+    // create the nodes in key order so neighbours share pool blocks
+    vector<Node*> incoming;
+    incoming.reserve(bids.size());
+    for (const pair<Probe, size_t>& entry : order) {
+        incoming.push_back(nodePool.Create(move(bids[entry.second])));
+    }
+
+    vector<Node*> existing;
+    flatten(existing);
+
+    // existing bids go first on equal ids, matching Insert
+    vector<Node*> nodes;
+    nodes.reserve(existing.size() + incoming.size());
+    merge(existing.begin(), existing.end(), incoming.begin(), incoming.end(),
+        back_inserter(nodes), [](const Node* a, const Node* b) {
+            return Traits::Less(probeOf(a), probeOf(b));
+        });
+
+    root = buildBalanced(nodes, 0, nodes.size());
+
+    if (filter != nullptr) {
+        rebuildFilter();
+    }
+}
+
+/**
+* Remove a bid
+*/
+template <typename Key>
+void BasicBinarySearchTree<Key>::Remove(string_view bidId) {
+    // logged first, a change the log cannot save throws before it is made
+    if (log != nullptr && Find(bidId) != nullptr) {
+        log->Remove(bidId);
+    }
+
+    // remove node with bidId from root
+    size_t before = Size();
+    root = removeNode(root, Traits::MakeProbe(bidId));
+
+    if (filter != nullptr && Size() < before) {
+        filter->NoteRemove();
+        if (filter->Stale()) {
+            rebuildFilter();
+        }
+    }
+}
+
+/**
+* Find a bid without copying it
+*
+* @param bidId The bid id to search for
+* @return The stored bid, or nullptr when not found. It stays valid
+*         until the bid is removed or the tree destroyed.
+*/
+template <typename Key>
+const Bid* BasicBinarySearchTree<Key>::Find(string_view bidId) const {
+    if (filter != nullptr && !filter->MightContain(bidId)) {
+        return nullptr;
+    }
+
+    Probe key = Traits::MakeProbe(bidId);
+    Node* current = root;
+
+    while (current != nullptr) {
+        Probe currentKey = probeOf(current);
+        if (Traits::Equal(currentKey, key)) {
+            return &current->bid;
+        }
+
+        if (Traits::Less(key, currentKey)) {
+            current = current->left;
+        }
+        else {
+            current = current->right;
+        }
+    }
+
+    if (filter != nullptr) {
+        filter->NoteFalsePositive();
+    }
+    return nullptr;
+}
+
+/**
+* Search for a bid
+*
+* @return A copy of the bid, or an empty bid when not found
+*/
+template <typename Key>
+Bid BasicBinarySearchTree<Key>::Search(string_view bidId) const {
+    const Bid* found = Find(bidId);
+    return found != nullptr ? *found : Bid();
+}
+
+/**
+* Find many bids at once, overlapping their cache misses
+*
+* Ids are taken BATCH_LANES at a time and their descents take turns
+* going down one level each. Every step prefetches the node it moves
+* to, so the load for one id is under way while the others compare.
+*
+* @param bidIds Ids to look up
+* @param count Number of ids
+* @param found Receives the stored bid for each id, or nullptr, valid
+*        as for Find
+*/
+template <typename Key>
+void BasicBinarySearchTree<Key>::SearchBatch(const string_view* bidIds, size_t count, const Bid** found) const {
+    Probe keys[BATCH_LANES];
+    Node* current[BATCH_LANES];
+    bool ruledOut[BATCH_LANES];
+
+    for (size_t first = 0; first < count; first += BATCH_LANES) {
+        size_t lanes = min(BATCH_LANES, count - first);
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            ruledOut[lane] = filter != nullptr && !filter->MightContain(bidIds[first + lane]);
+            keys[lane] = Traits::MakeProbe(bidIds[first + lane]);
+            current[lane] = ruledOut[lane] ? nullptr : root;
+            found[first + lane] = nullptr;
+        }
+
+        size_t active = lanes;
+        while (active > 0) {
+            active = 0;
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                Node* node = current[lane];
+                if (node == nullptr) {
+                    continue;
+                }
+
+                Probe nodeKey = probeOf(node);
+                if (Traits::Equal(nodeKey, keys[lane])) {
+                    found[first + lane] = &node->bid;
+                    current[lane] = nullptr;
+                    continue;
+                }
+
+                node = Traits::Less(keys[lane], nodeKey) ? node->left : node->right;
+                if (node != nullptr) {
+                    prefetch(node);
+                    ++active;
+                }
+                current[lane] = node;
+            }
+        }
+
+        if (filter != nullptr) {
+            for (size_t lane = 0; lane < lanes; ++lane) {
+                if (!ruledOut[lane] && found[first + lane] == nullptr) {
+                    filter->NoteFalsePositive();
+                }
+            }
+        }
+    }
+}
+
+/**
+* Move to the next bid in id order
+*/
+template <typename Key>
+auto BasicBinarySearchTree<Key>::Iterator::operator++() -> Iterator& {
+    const Node* node = pending.back()->right;
+    pending.pop_back();
+    while (node != nullptr) {
+        pending.push_back(node);
+        node = node->left;
+    }
+    return *this;
+}
+
+/**
+* Iterator at the smallest bid id
+*/
+template <typename Key>
+auto BasicBinarySearchTree<Key>::begin() const -> Iterator {
+    Iterator it;
+    for (const Node* node = root; node != nullptr; node = node->left) {
+        it.pending.push_back(node);
+    }
+    return it;
+}
+
+/**
+* Iterator past the largest bid id
+*/
+template <typename Key>
+auto BasicBinarySearchTree<Key>::end() const -> Iterator {
+    return Iterator();
+}
+
+/**
+* Iterator at the first bid whose id is not less than bidId
+*/
+template <typename Key>
+auto BasicBinarySearchTree<Key>::LowerBound(string_view bidId) const -> Iterator {
+    Iterator it;
+    Probe key = Traits::MakeProbe(bidId);
+    const Node* node = root;
+    while (node != nullptr) {
+        if (Traits::Less(probeOf(node), key)) {
+            node = node->right;
+        }
+        else {
+            it.pending.push_back(node);
+            node = node->left;
+        }
+    }
+    return it;
+}
+
+/**
+* Iterator at the first bid whose id is greater than bidId
+*/
+template <typename Key>
+auto BasicBinarySearchTree<Key>::UpperBound(string_view bidId) const -> Iterator {
+    Iterator it;
+    Probe key = Traits::MakeProbe(bidId);
+    const Node* node = root;
+    while (node != nullptr) {
+        if (Traits::Less(key, probeOf(node))) {
+            it.pending.push_back(node);
+            node = node->left;
+        }
+        else {
+            node = node->right;
+        }
+    }
+    return it;
+}
+
+/**
+* All bids with ids in [low, high), in id order
+*
+* @param low Smallest id to include
+* @param high First id past the range
+* @return The stored bids, valid until they are removed
+*/
+template <typename Key>
+vector<const Bid*> BasicBinarySearchTree<Key>::Range(string_view low, string_view high) const {
+    vector<const Bid*> bids;
+    Probe highKey = Traits::MakeProbe(high);
+    for (Iterator it = LowerBound(low); it != end(); ++it) {
+        if (!Traits::Less(probeOf(it.pending.back()), highKey)) {
+            break;
+        }
+        bids.push_back(&*it);
+    }
+    return bids;
+}
+
+/**
+* Number of bids whose id is less than bidId, O(log n)
+*/
+template <typename Key>
+size_t BasicBinarySearchTree<Key>::Rank(string_view bidId) const {
+    size_t rank = 0;
+    Probe key = Traits::MakeProbe(bidId);
+    const Node* node = root;
+    while (node != nullptr) {
+        if (Traits::Less(probeOf(node), key)) {
+            rank += size(node->left) + 1;
+            node = node->right;
+        }
+        else {
+            node = node->left;
+        }
+    }
+    return rank;
+}
+
+/**
+* Bid at a position in id order, O(log n)
+*
+* @param rank Zero based position
+* @return The stored bid, or nullptr when rank is past the end
+*/
+template <typename Key>
+const Bid* BasicBinarySearchTree<Key>::Select(size_t rank) const {
+    const Node* node = root;
+    while (node != nullptr) {
+        size_t leftSize = size(node->left);
+        if (rank < leftSize) {
+            node = node->left;
+        }
+        else if (rank == leftSize) {
+            return &node->bid;
+        }
+        else {
+            rank -= leftSize + 1;
+            node = node->right;
+        }
+    }
+    return nullptr;
+}
+
+/**
+* Number of bids with ids in [low, high), O(log n)
+*/
+template <typename Key>
+size_t BasicBinarySearchTree<Key>::CountRange(string_view low, string_view high) const {
+    if (!Traits::Less(Traits::MakeProbe(low), Traits::MakeProbe(high))) {
+        return 0;
+    }
+    return Rank(high) - Rank(low);
+}
+
+/**
+* Total amount of the bids with ids in [low, high), O(log n)
+*
+* Descends once to where the bounds part ways, then adds the subtree
+* sums hanging inside the range along each bound's path.
+*/
+template <typename Key>
+double BasicBinarySearchTree<Key>::SumRange(string_view low, string_view high) const {
+    Probe lowKey = Traits::MakeProbe(low);
+    Probe highKey = Traits::MakeProbe(high);
+    if (!Traits::Less(lowKey, highKey)) {
+        return 0.0;
+    }
+
+    // find the first node inside the range, where the two paths split
+    const Node* split = root;
+    while (split != nullptr) {
+        if (Traits::Less(probeOf(split), lowKey)) {
+            split = split->right;
+        }
+        else if (!Traits::Less(probeOf(split), highKey)) {
+            split = split->left;
+        }
+        else {
+            break;
+        }
+    }
+    if (split == nullptr) {
+        return 0.0;
+    }
+
+    double total = split->bid.amount;
+
+    // left path: everything at or above low
+    for (const Node* node = split->left; node != nullptr;) {
+        if (Traits::Less(probeOf(node), lowKey)) {
+            node = node->right;
+        }
+        else {
+            total += node->bid.amount + amountSum(node->right);
+            node = node->left;
+        }
+    }
+
+    // right path: everything below high
+    for (const Node* node = split->right; node != nullptr;) {
+        if (Traits::Less(probeOf(node), highKey)) {
+            total += node->bid.amount + amountSum(node->left);
+            node = node->right;
+        }
+        else {
+            node = node->left;
+        }
     }
+    return total;
+}
+
+/**
+* Number of bids in the tree
+*/
+template <typename Key>
+size_t BasicBinarySearchTree<Key>::Size() const {
+    return size(root);
+}
+
+/**
+* Height of the tree, 0 when empty
+*/
+template <typename Key>
+int BasicBinarySearchTree<Key>::Height() {
+    return height(root);
+}
+
+/**
+* Node allocator statistics
+*/
+template <typename Key>
+NodePoolStats BasicBinarySearchTree<Key>::AllocatorStats() {
+    return nodePool.GetStats();
+}
+
+/**
+* Put a bloom filter in front of lookups, replacing any earlier one
+*
+* @param bitsPerKey Filter bits per bid, see BloomFilter
+*/
+template <typename Key>
+void BasicBinarySearchTree<Key>::EnableFilter(double bitsPerKey) {
+    delete filter;
+    filter = new BloomFilter(FILTER_MIN_KEYS, bitsPerKey);
+    rebuildFilter();
+}
+
+/**
+* Drop the bloom filter, every lookup descends the tree again
+*/
+template <typename Key>
+void BasicBinarySearchTree<Key>::DisableFilter() {
+    delete filter;
+    filter = nullptr;
+}
+
+/**
+* Bloom filter statistics, all zero when there is no filter
+*/
+template <typename Key>
+BloomFilterStats BasicBinarySearchTree<Key>::FilterStats() {
+    return filter != nullptr ? filter->GetStats() : BloomFilterStats();
+}
+
+/**
+* Record later inserts and removes in a change log
+*
+* @param aLog Log to append to, or nullptr to stop recording. The
+*        caller keeps ownership.
+*/
+template <typename Key>
+void BasicBinarySearchTree<Key>::AttachLog(BidLog* aLog) {
+    log = aLog;
+}
+
+/**
+* Refill the bloom filter from the stored bids, sized for a quarter
+* more so growth does not make it stale again right away
+*/
+template <typename Key>
+void BasicBinarySearchTree<Key>::rebuildFilter() {
+    filter->Reset(max(Size() + Size() / 4, FILTER_MIN_KEYS));
+    for (const Bid& bid : *this) {
+        filter->Add(bid.bidId);
+    }
+}
+
+/**
+* Add a new node below some node (recursive)
+*
+* Recursion depth is bounded by the tree height, which the
+* rebalancing on the way back up keeps at O(log n).
+*
+* @param node Current node in tree
+* @param leaf New node holding the bid to be added
+* @return The new root of this subtree
+*/
+template <typename Key>
+auto BasicBinarySearchTree<Key>::addNode(Node* node, Node* leaf) -> Node* {
+    // empty spot found, the new node goes here
+    if (node == nullptr) {
+        return leaf;
+    }
+
+    // if bid is less than node's bid recurse down the left node,
+    // equal ids go right like before
+    if (Traits::Less(probeOf(leaf), probeOf(node))) {
+        node->left = addNode(node->left, leaf);
+    }
+    else {
+        node->right = addNode(node->right, leaf);
+    }
+
+    return rebalance(node);
+}
+
+/**
+* Remove a bid from some node (recursive)
+*
+* @param node Current node in tree
+* @param key Key of the bid id to remove
+* @return The new root of this subtree
+*/
+template <typename Key>
+auto BasicBinarySearchTree<Key>::removeNode(Node* node, const Probe& key) -> Node* {
+    if (node == nullptr) {
+        return node;
+    }
+
+    if (Traits::Less(key, probeOf(node))) {
+        node->left = removeNode(node->left, key);
+    }
+    else if (Traits::Less(probeOf(node), key)) {
+        node->right = removeNode(node->right, key);
+    }
+    else {
+        if (node->left == nullptr) {
+            Node* temp = node->right;
+            nodePool.Destroy(node);
+            return temp;
+        }
+        else if (node->right == nullptr) {
+            Node* temp = node->left;
+            nodePool.Destroy(node);
+            return temp;
+        }
+
+        // splice the in-order successor into this node's place
+        Node* successor = nullptr;
+        Node* right = removeMin(node->right, successor);
+        successor->left = node->left;
+        successor->right = right;
+        nodePool.Destroy(node);
+        node = successor;
+    }
+    return rebalance(node);
+}
+
+/**
+* Unlink the smallest node of a subtree (recursive)
+*
+* @param node Current node in tree
+* @param minNode Receives the unlinked node
+* @return The new root of this subtree
+*/
+template <typename Key>
+auto BasicBinarySearchTree<Key>::removeMin(Node* node, Node*& minNode) -> Node* {
+    if (node->left == nullptr) {
+        minNode = node;
+        return node->right;
+    }
+    node->left = removeMin(node->left, minNode);
+    return rebalance(node);
+}
+
+/**
+* Link a sorted run of nodes into a balanced subtree (recursive)
+*
+* Recursion depth is log2 of the run length.
+*
+* @param nodes Nodes sorted by bid id
+* @param begin First index of the run
+* @param end One past the last index of the run
+* @return The root of the new subtree
+*/
+template <typename Key>
+auto BasicBinarySearchTree<Key>::buildBalanced(vector<Node*>& nodes, size_t begin, size_t end) -> Node* {
+    if (begin >= end) {
+        return nullptr;
+    }
+
+    size_t middle = begin + (end - begin) / 2;
+    Node* node = nodes[middle];
+    node->left = buildBalanced(nodes, begin, middle);
+    node->right = buildBalanced(nodes, middle + 1, end);
+    update(node);
+    return node;
+}
+
+/**
+* Unlink every node of the tree into a vector, in order
+*
+* @param nodes Receives the nodes sorted by bid id
+*/
+template <typename Key>
+void BasicBinarySearchTree<Key>::flatten(vector<Node*>& nodes) {
+    vector<Node*> stack;
+    Node* current = root;
+    while (current != nullptr || !stack.empty()) {
+        while (current != nullptr) {
+            stack.push_back(current);
+            current = current->left;
+        }
+        current = stack.back();
+        stack.pop_back();
+        nodes.push_back(current);
+        current = current->right;
+    }
+    root = nullptr;
+}
+
+/**
+* Comparison key of a node's bid
+*/
+template <typename Key>
+auto BasicBinarySearchTree<Key>::probeOf(const Node* node) -> Probe {
+    return Traits::ProbeOf(*node);
+}
+
+/**
+* Height of a possibly empty subtree
+*/
+template <typename Key>
+int BasicBinarySearchTree<Key>::height(Node* node) {
+    return node == nullptr ? 0 : node->height;
+}
+
+/**
+* Number of bids in a possibly empty subtree
+*/
+template <typename Key>
+size_t BasicBinarySearchTree<Key>::size(const Node* node) {
+    return node == nullptr ? 0 : node->size;
+}
+
+/**
+* Total amount of a possibly empty subtree
+*/
+template <typename Key>
+double BasicBinarySearchTree<Key>::amountSum(const Node* node) {
+    return node == nullptr ? 0.0 : node->amountSum;
+}
+
+/**
+* Recompute a node's height, size and amount total from its children
+*/
+template <typename Key>
+void BasicBinarySearchTree<Key>::update(Node* node) {
+    node->height = 1 + max(height(node->left), height(node->right));
+    node->size = 1 + size(node->left) + size(node->right);
+    node->amountSum = node->bid.amount + amountSum(node->left) + amountSum(node->right);
+}
+
+/**
+* Rotate a subtree left, the right child becomes the new root
+*/
+template <typename Key>
+auto BasicBinarySearchTree<Key>::rotateLeft(Node* node) -> Node* {
+    Node* pivot = node->right;
+    node->right = pivot->left;
+    pivot->left = node;
+    update(node);
+    update(pivot);
+    return pivot;
+}
+
+/**
+* Rotate a subtree right, the left child becomes the new root
+*/
+template <typename Key>
+auto BasicBinarySearchTree<Key>::rotateRight(Node* node) -> Node* {
+    Node* pivot = node->left;
+    node->left = pivot->right;
+    pivot->right = node;
+    update(node);
+    update(pivot);
+    return pivot;
+}
+
+/**
+* Restore the AVL property at a node whose children may differ
+* in height by two after an insert or remove below it
+*
+* @param node Current node in tree
+* @return The new root of this subtree
+*/
+template <typename Key>
+auto BasicBinarySearchTree<Key>::rebalance(Node* node) -> Node* {
+    update(node);
+    int balance = height(node->left) - height(node->right);
+
+    if (balance > 1) {
+        // left-right case turns into left-left first
+        if (height(node->left->left) < height(node->left->right)) {
+            node->left = rotateLeft(node->left);
+        }
+        return rotateRight(node);
+    }
+    if (balance < -1) {
+        // right-left case turns into right-right first
+        if (height(node->right->right) < height(node->right->left)) {
+            node->right = rotateRight(node->right);
+        }
+        return rotateLeft(node);
+    }
+    return node;
+}
+
+//============================================================================
+// Read-only snapshot class definition
+//============================================================================
+
+/**
+* Immutable copy of a tree laid out for fast lookups
+*
+* Bids are stored in Eytzinger (breadth first) order in one array, so
+* the first levels of every search share the same few cache lines and
+* the children of slot k sit together at slots 2k and 2k + 1. A
+* parallel array holds the first 8 bytes of each id as an integer,
+* which is what the search loop compares, falling back to the full id
+* only when those bytes tie.
+*/
+class BidSnapshot {
+
+private:
+    vector<uint64_t> prefixes;  // slot 0 is unused so children are 2k, 2k + 1
+    vector<Bid> bids;
+
+    size_t fill(vector<Bid>& sorted, size_t next, size_t slot);
+    static uint64_t keyPrefix(string_view bidId);
+
+public:
+    BidSnapshot(vector<Bid> sorted);
+    const Bid* Find(string_view bidId) const;
+    Bid Search(string_view bidId) const;
+    size_t Size();
+};
+
+/**
+* Build a snapshot
+*
+* @param sorted Bids, usually already sorted by id string
+*/
+BidSnapshot::BidSnapshot(vector<Bid> sorted) {
+    // trees keyed on numbers hand their bids over in numeric order
+    auto byId = [](const Bid& a, const Bid& b) {
+        return a.bidId < b.bidId;
+    };
+    if (!is_sorted(sorted.begin(), sorted.end(), byId)) {
+        stable_sort(sorted.begin(), sorted.end(), byId);
+    }
+
+    prefixes.resize(sorted.size() + 1);
+    bids.resize(sorted.size() + 1);
+    fill(sorted, 0, 1);
+}
+
+/**
+* Move sorted bids into Eytzinger order by walking the implicit
+* tree in order (recursive, depth is log2 of the size)
+*
+* @param sorted Bids sorted by id
+* @param next Index of the next sorted bid to place
+* @param slot Current slot in the implicit tree
+* @return Index of the next sorted bid to place afterwards
+*/
+size_t BidSnapshot::fill(vector<Bid>& sorted, size_t next, size_t slot) {
+    if (slot < bids.size()) {
+        next = fill(sorted, next, 2 * slot);
+        prefixes[slot] = keyPrefix(sorted[next].bidId);
+        bids[slot] = move(sorted[next++]);
+        next = fill(sorted, next, 2 * slot + 1);
+    }
+    return next;
+}
+
+/**
+* First 8 bytes of an id packed big endian, zero padded, so integer
+* order agrees with string order whenever the prefixes differ
+*/
+uint64_t BidSnapshot::keyPrefix(string_view bidId) {
+    uint64_t prefix = 0;
+    for (size_t i = 0; i < 8; ++i) {
+        unsigned char ch = i < bidId.size() ? bidId[i] : 0;
+        prefix = (prefix << 8) | ch;
+    }
+    return prefix;
+}
+
+/**
+* Find a bid without copying it
+*
+* The descent has no data dependent branch on the common path: each
+* step picks a child with arithmetic, and the slots four levels down
+* are prefetched since their 16 prefixes share two cache lines.
+*
+* @param bidId The bid id to search for
+* @return The stored bid, or nullptr when not found
+*/
+const Bid* BidSnapshot::Find(string_view bidId) const {
+    uint64_t prefix = keyPrefix(bidId);
+    size_t size = bids.size();
+    size_t slot = 1;
+
+    while (slot < size) {
+        if (16 * slot < size) {
+            prefetch(&prefixes[16 * slot]);
+        }
+        bool right = prefixes[slot] < prefix
+            || (prefixes[slot] == prefix && bids[slot].bidId < bidId);
+        slot = 2 * slot + right;
+    }
+
+    // undo the trailing right turns, the last left turn was the lower bound
+    while (slot & 1) {
+        slot >>= 1;
+    }
+    slot >>= 1;
+
+    if (slot != 0 && bids[slot].bidId == bidId) {
+        return &bids[slot];
+    }
+
+    return nullptr;
+}
+
+/**
+* Search for a bid
+*
+* @return A copy of the bid, or an empty bid when not found
+*/
+Bid BidSnapshot::Search(string_view bidId) const {
+    const Bid* found = Find(bidId);
+    return found != nullptr ? *found : Bid();
+}
+
+/**
+* Number of bids in the snapshot
+*/
+size_t BidSnapshot::Size() {
+    return bids.size() - 1;
+}
+
+/**
+* Copy the current bids into a read-only snapshot for fast lookups
+*
+* The snapshot does not see later changes to the tree.
+*
+* @return A new snapshot owned by the caller
+*/
+template <typename Key>
+BidSnapshot* BasicBinarySearchTree<Key>::Freeze() {
+    vector<Bid> sorted;
+    sorted.reserve(Size());
+
+    vector<Node*> stack;
+    Node* current = root;
+    while (current != nullptr || !stack.empty()) {
+        while (current != nullptr) {
+            stack.push_back(current);
+            current = current->left;
+        }
+        current = stack.back();
+        stack.pop_back();
+        sorted.push_back(current->bid);
+        current = current->right;
+    }
+
+    return new BidSnapshot(move(sorted));
+}
+
+//============================================================================
+// B+ tree class definition
+//============================================================================
+
+// most keys a B+ tree node holds, nodes other than the root keep at least half
+const int BTREE_MAX_KEYS = 16;
+const int BTREE_MIN_KEYS = BTREE_MAX_KEYS / 2;
+
+// Fields shared by inner and leaf nodes. Arrays have one spare slot so a
+// node can overflow by one entry before it is split.
+struct BTreeNode {
+    bool leaf;
+    int count;
+    string keys[BTREE_MAX_KEYS + 1];
+
+    BTreeNode(bool isLeaf) {
+        leaf = isLeaf;
+        count = 0;
+    }
+};
+
+// Inner node, children[i] holds ids between keys[i - 1] and keys[i] inclusive
+struct BTreeInner : BTreeNode {
+    BTreeNode* children[BTREE_MAX_KEYS + 2];
+
+    BTreeInner() : BTreeNode(false) {
+    }
+};
+
+// Leaf node, bids[i] is stored under keys[i] and leaves are chained in order
+struct BTreeLeaf : BTreeNode {
+    Bid bids[BTREE_MAX_KEYS + 1];
+    BTreeLeaf* next;
+
+    BTreeLeaf() : BTreeNode(true) {
+        next = nullptr;
+    }
+};
+
+/**
+* Define a class containing data members and methods to
+* implement a B+ tree of bids
+*
+* Wide nodes keep a packed array of ids so a lookup touches a handful
+* of nodes instead of one node per level, and the bids live only in
+* the leaves, which are linked for in order iteration. It offers the
+* same operations as BinarySearchTree so the two can be swapped.
+*/
+class BidBTree {
+
+private:
+    BTreeNode* root;
+    int levels;
+    NodePool<BTreeLeaf> leafPool;
+    NodePool<BTreeInner> innerPool;
+
+    BTreeLeaf* firstLeaf();
+    BTreeNode* addEntry(BTreeNode* node, Bid& bid, string& separator);
+    bool removeEntry(BTreeNode* node, string_view bidId);
+    void fixUnderflow(BTreeInner* parent, int index);
+    void destroy(BTreeNode* node);
+
+public:
+    BidBTree();
+    virtual ~BidBTree();
+    void InOrder();
+    void Insert(const Bid& bid);
+    void Insert(Bid&& bid);
+    void BulkLoad(vector<Bid> bids);
+    void Remove(string_view bidId);
+    const Bid* Find(string_view bidId) const;
+    Bid Search(string_view bidId) const;
+    int Height();
+};
+
+/**
+* Default constructor
+*/
+BidBTree::BidBTree() {
+    root = leafPool.Create();
+    levels = 1;
+}
+
+/**
+* Destructor
+*/
+BidBTree::~BidBTree() {
+    destroy(root);
+}
+
+/**
+* Destroy a subtree (recursive, depth is the tree height)
+*/
+void BidBTree::destroy(BTreeNode* node) {
+    if (node->leaf) {
+        leafPool.Destroy(static_cast<BTreeLeaf*>(node));
+        return;
+    }
+    BTreeInner* inner = static_cast<BTreeInner*>(node);
+    for (int i = 0; i <= inner->count; ++i) {
+        destroy(inner->children[i]);
+    }
+    innerPool.Destroy(inner);
+}
+
+/**
+* Leftmost leaf, where in order iteration starts
+*/
+BTreeLeaf* BidBTree::firstLeaf() {
+    BTreeNode* node = root;
+    while (!node->leaf) {
+        node = static_cast<BTreeInner*>(node)->children[0];
+    }
+    return static_cast<BTreeLeaf*>(node);
+}
+
+/**
+* Traverse the tree in order by following the leaf chain
+*/
+void BidBTree::InOrder() {
+    for (BTreeLeaf* leaf = firstLeaf(); leaf != nullptr; leaf = leaf->next) {
+        for (int i = 0; i < leaf->count; ++i) {
+            const Bid& bid = leaf->bids[i];
+            cout << bid.bidId << ": " << bid.title << " | "
+                << bid.amount << " | " << bid.fund << endl;
+        }
+    }
+}
+
+/**
+* Insert a copy of a bid
+*/
+void BidBTree::Insert(const Bid& bid) {
+    Insert(Bid(bid));
+}
+
+/**
+* Insert a bid, moving its strings into the tree
+*/
+void BidBTree::Insert(Bid&& bid) {
+    string separator;
+    BTreeNode* sibling = addEntry(root, bid, separator);
+
+    // the root split, grow the tree by one level
+    if (sibling != nullptr) {
+        BTreeInner* newRoot = innerPool.Create();
+        newRoot->keys[0] = move(separator);
+        newRoot->children[0] = root;
+        newRoot->children[1] = sibling;
+        newRoot->count = 1;
+        root = newRoot;
+        ++levels;
+    }
+}
+
+/**
+* Load many bids at once
+*
+* The bids are sorted by id once and merged with any bids already in
+* the tree, then the tree is rebuilt bottom up in a single linear pass:
+* packed leaves first, then each level of inner nodes over the one
+* below, instead of paying a descent and the splits per row. Nodes on
+* a level share the entries evenly, so none is less than half full.
+*
+* @param bids The bids to add
+*/
+void BidBTree::BulkLoad(vector<Bid> bids) {
+    auto byId = [](const Bid& a, const Bid& b) {
+        return a.bidId < b.bidId;
+    };
+    stable_sort(bids.begin(), bids.end(), byId);
+
+    // stored bids go first among equal ids, like Insert places them
+    if (!root->leaf || root->count > 0) {
+        vector<Bid> stored;
+        for (BTreeLeaf* leaf = firstLeaf(); leaf != nullptr; leaf = leaf->next) {
+            for (int i = 0; i < leaf->count; ++i) {
+                stored.push_back(move(leaf->bids[i]));
+            }
+        }
+        vector<Bid> merged;
+        merged.reserve(stored.size() + bids.size());
+        merge(make_move_iterator(stored.begin()), make_move_iterator(stored.end()),
+            make_move_iterator(bids.begin()), make_move_iterator(bids.end()), back_inserter(merged), byId);
+        bids = move(merged);
+    }
+    destroy(root);
+
+    // leaves, chained in order, with the first id below each node
+    size_t leafCount = max<size_t>(1, (bids.size() + BTREE_MAX_KEYS - 1) / BTREE_MAX_KEYS);
+    vector<BTreeNode*> level;
+    vector<string> firstIds;
+    BTreeLeaf* previous = nullptr;
+    size_t next = 0;
+    for (size_t i = 0; i < leafCount; ++i) {
+        BTreeLeaf* leaf = leafPool.Create();
+        for (size_t end = bids.size() * (i + 1) / leafCount; next < end; ++next) {
+            leaf->keys[leaf->count] = bids[next].bidId;
+            leaf->bids[leaf->count] = move(bids[next]);
+            ++leaf->count;
+        }
+        if (previous != nullptr) {
+            previous->next = leaf;
+        }
+        previous = leaf;
+        level.push_back(leaf);
+        firstIds.push_back(leaf->count > 0 ? leaf->keys[0] : string());
+    }
+    levels = 1;
+
+    // inner levels until a single node is left to be the root
+    while (level.size() > 1) {
+        size_t innerCount = (level.size() + BTREE_MAX_KEYS) / (BTREE_MAX_KEYS + 1);
+        vector<BTreeNode*> parents;
+        vector<string> parentIds;
+        size_t child = 0;
+        for (size_t i = 0; i < innerCount; ++i) {
+            BTreeInner* inner = innerPool.Create();
+            parentIds.push_back(move(firstIds[child]));
+            inner->children[0] = level[child++];
+            for (size_t end = level.size() * (i + 1) / innerCount; child < end; ++child) {
+                inner->keys[inner->count] = move(firstIds[child]);
+                inner->children[inner->count + 1] = level[child];
+                ++inner->count;
+            }
+            parents.push_back(inner);
+        }
+        level.swap(parents);
+        firstIds.swap(parentIds);
+        ++levels;
+    }
+    root = level[0];
+}
+
+/**
+* Add a bid below some node (recursive)
+*
+* Equal ids are placed after the ones already stored, like the
+* binary search tree does.
+*
+* @param node Current node in tree
+* @param bid Bid to be added
+* @param separator Receives the first id of the new sibling on a split
+* @return The new right sibling if the node split, otherwise nullptr
+*/
+BTreeNode* BidBTree::addEntry(BTreeNode* node, Bid& bid, string& separator) {
+    int index = int(upper_bound(node->keys, node->keys + node->count, bid.bidId) - node->keys);
+
+    if (node->leaf) {
+        BTreeLeaf* leaf = static_cast<BTreeLeaf*>(node);
+        for (int i = leaf->count; i > index; --i) {
+            leaf->keys[i] = move(leaf->keys[i - 1]);
+            leaf->bids[i] = move(leaf->bids[i - 1]);
+        }
+        leaf->keys[index] = bid.bidId;
+        leaf->bids[index] = move(bid);
+        ++leaf->count;
+
+        if (leaf->count <= BTREE_MAX_KEYS) {
+            return nullptr;
+        }
+
+        // split the upper half into a new leaf and link it in
+        BTreeLeaf* right = leafPool.Create();
+        int half = leaf->count / 2;
+        for (int i = half; i < leaf->count; ++i) {
+            right->keys[i - half] = move(leaf->keys[i]);
+            right->bids[i - half] = move(leaf->bids[i]);
+        }
+        right->count = leaf->count - half;
+        leaf->count = half;
+        right->next = leaf->next;
+        leaf->next = right;
+        separator = right->keys[0];
+        return right;
+    }
+
+    BTreeInner* inner = static_cast<BTreeInner*>(node);
+    string childSeparator;
+    BTreeNode* childSibling = addEntry(inner->children[index], bid, childSeparator);
+    if (childSibling == nullptr) {
+        return nullptr;
+    }
+
+    for (int i = inner->count; i > index; --i) {
+        inner->keys[i] = move(inner->keys[i - 1]);
+        inner->children[i + 1] = inner->children[i];
+    }
+    inner->keys[index] = move(childSeparator);
+    inner->children[index + 1] = childSibling;
+    ++inner->count;
+
+    if (inner->count <= BTREE_MAX_KEYS) {
+        return nullptr;
+    }
+
+    // split around the middle key, which moves up to the parent
+    BTreeInner* right = innerPool.Create();
+    int half = inner->count / 2;
+    separator = move(inner->keys[half]);
+    for (int i = half + 1; i < inner->count; ++i) {
+        right->keys[i - half - 1] = move(inner->keys[i]);
+    }
+    for (int i = half + 1; i <= inner->count; ++i) {
+        right->children[i - half - 1] = inner->children[i];
+    }
+    right->count = inner->count - half - 1;
+    inner->count = half;
+    return right;
+}
+
+/**
+* Remove a bid
+*/
+void BidBTree::Remove(string_view bidId) {
+    removeEntry(root, bidId);
+
+    // an inner root left with a single child hands over to it
+    if (!root->leaf && root->count == 0) {
+        BTreeInner* oldRoot = static_cast<BTreeInner*>(root);
+        root = oldRoot->children[0];
+        innerPool.Destroy(oldRoot);
+        --levels;
+    }
+}
+
+/**
+* Remove the first bid with an id below some node (recursive)
+*
+* @param node Current node in tree
+* @param bidId The bid id to remove
+* @return True when a bid was removed
+*/
+bool BidBTree::removeEntry(BTreeNode* node, string_view bidId) {
+    int index = int(lower_bound(node->keys, node->keys + node->count, bidId) - node->keys);
+
+    if (node->leaf) {
+        BTreeLeaf* leaf = static_cast<BTreeLeaf*>(node);
+        if (index == leaf->count || leaf->keys[index] != bidId) {
+            return false;
+        }
+        for (int i = index; i < leaf->count - 1; ++i) {
+            leaf->keys[i] = move(leaf->keys[i + 1]);
+            leaf->bids[i] = move(leaf->bids[i + 1]);
+        }
+        --leaf->count;
+        return true;
+    }
+
+    // copies of an id may straddle a separator equal to it, so try
+    // every child the id can be in, leftmost first
+    BTreeInner* inner = static_cast<BTreeInner*>(node);
+    for (int i = index; i <= inner->count; ++i) {
+        if (i > index && inner->keys[i - 1] != bidId) {
+            break;
+        }
+        if (removeEntry(inner->children[i], bidId)) {
+            if (inner->children[i]->count < BTREE_MIN_KEYS) {
+                fixUnderflow(inner, i);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+* Refill a child that dropped below the minimum by borrowing from
+* a sibling, or merge it with one
+*
+* @param parent Parent of the underfull child
+* @param index Position of the child in the parent
+*/
+void BidBTree::fixUnderflow(BTreeInner* parent, int index) {
+    BTreeNode* child = parent->children[index];
+    BTreeNode* left = index > 0 ? parent->children[index - 1] : nullptr;
+    BTreeNode* right = index < parent->count ? parent->children[index + 1] : nullptr;
+
+    if (child->leaf) {
+        BTreeLeaf* leaf = static_cast<BTreeLeaf*>(child);
+
+        if (left != nullptr && left->count > BTREE_MIN_KEYS) {
+            // move the left sibling's last bid to the front
+            BTreeLeaf* from = static_cast<BTreeLeaf*>(left);
+            for (int i = leaf->count; i > 0; --i) {
+                leaf->keys[i] = move(leaf->keys[i - 1]);
+                leaf->bids[i] = move(leaf->bids[i - 1]);
+            }
+            --from->count;
+            leaf->keys[0] = move(from->keys[from->count]);
+            leaf->bids[0] = move(from->bids[from->count]);
+            ++leaf->count;
+            parent->keys[index - 1] = leaf->keys[0];
+            return;
+        }
+        if (right != nullptr && right->count > BTREE_MIN_KEYS) {
+            // move the right sibling's first bid to the end
+            BTreeLeaf* from = static_cast<BTreeLeaf*>(right);
+            leaf->keys[leaf->count] = move(from->keys[0]);
+            leaf->bids[leaf->count] = move(from->bids[0]);
+            ++leaf->count;
+            for (int i = 0; i < from->count - 1; ++i) {
+                from->keys[i] = move(from->keys[i + 1]);
+                from->bids[i] = move(from->bids[i + 1]);
+            }
+            --from->count;
+            parent->keys[index] = from->keys[0];
+            return;
+        }
+
+        // merge with a sibling, always folding the right node into the left
+        if (left == nullptr) {
+            ++index;
+        }
+        BTreeLeaf* into = static_cast<BTreeLeaf*>(parent->children[index - 1]);
+        BTreeLeaf* from = static_cast<BTreeLeaf*>(parent->children[index]);
+        for (int i = 0; i < from->count; ++i) {
+            into->keys[into->count + i] = move(from->keys[i]);
+            into->bids[into->count + i] = move(from->bids[i]);
+        }
+        into->count += from->count;
+        into->next = from->next;
+        leafPool.Destroy(from);
+    }
+    else {
+        BTreeInner* inner = static_cast<BTreeInner*>(child);
+
+        if (left != nullptr && left->count > BTREE_MIN_KEYS) {
+            // rotate through the parent: separator down, left's last key up
+            BTreeInner* from = static_cast<BTreeInner*>(left);
+            for (int i = inner->count; i > 0; --i) {
+                inner->keys[i] = move(inner->keys[i - 1]);
+            }
+            for (int i = inner->count + 1; i > 0; --i) {
+                inner->children[i] = inner->children[i - 1];
+            }
+            inner->keys[0] = move(parent->keys[index - 1]);
+            inner->children[0] = from->children[from->count];
+            ++inner->count;
+            --from->count;
+            parent->keys[index - 1] = move(from->keys[from->count]);
+            return;
+        }
+        if (right != nullptr && right->count > BTREE_MIN_KEYS) {
+            // rotate through the parent: separator down, right's first key up
+            BTreeInner* from = static_cast<BTreeInner*>(right);
+            inner->keys[inner->count] = move(parent->keys[index]);
+            inner->children[inner->count + 1] = from->children[0];
+            ++inner->count;
+            parent->keys[index] = move(from->keys[0]);
+            for (int i = 0; i < from->count - 1; ++i) {
+                from->keys[i] = move(from->keys[i + 1]);
+            }
+            for (int i = 0; i < from->count; ++i) {
+                from->children[i] = from->children[i + 1];
+            }
+            --from->count;
+            return;
+        }
+
+        // merge with a sibling, pulling the separator down between them
+        if (left == nullptr) {
+            ++index;
+        }
+        BTreeInner* into = static_cast<BTreeInner*>(parent->children[index - 1]);
+        BTreeInner* from = static_cast<BTreeInner*>(parent->children[index]);
+        into->keys[into->count] = move(parent->keys[index - 1]);
+        for (int i = 0; i < from->count; ++i) {
+            into->keys[into->count + 1 + i] = move(from->keys[i]);
+        }
+        for (int i = 0; i <= from->count; ++i) {
+            into->children[into->count + 1 + i] = from->children[i];
+        }
+        into->count += from->count + 1;
+        innerPool.Destroy(from);
+    }
+
+    // drop the separator and pointer of the merged away node
+    for (int i = index - 1; i < parent->count - 1; ++i) {
+        parent->keys[i] = move(parent->keys[i + 1]);
+    }
+    for (int i = index; i < parent->count; ++i) {
+        parent->children[i] = parent->children[i + 1];
+    }
+    --parent->count;
+}
+
+/**
+* Find a bid without copying it
+*
+* @param bidId The bid id to search for
+* @return The stored bid, or nullptr when not found
+*/
+const Bid* BidBTree::Find(string_view bidId) const {
+    BTreeNode* node = root;
+    while (!node->leaf) {
+        int index = int(lower_bound(node->keys, node->keys + node->count, bidId) - node->keys);
+        node = static_cast<BTreeInner*>(node)->children[index];
+    }
+
+    // the first copy of an id can sit at the start of the next leaf
+    BTreeLeaf* leaf = static_cast<BTreeLeaf*>(node);
+    int index = int(lower_bound(leaf->keys, leaf->keys + leaf->count, bidId) - leaf->keys);
+    if (index == leaf->count && leaf->next != nullptr) {
+        leaf = leaf->next;
+        index = 0;
+    }
+    if (index < leaf->count && leaf->keys[index] == bidId) {
+        return &leaf->bids[index];
+    }
+
+    return nullptr;
+}
+
+/**
+* Search for a bid
+*
+* @return A copy of the bid, or an empty bid when not found
+*/
+Bid BidBTree::Search(string_view bidId) const {
+    const Bid* found = Find(bidId);
+    return found != nullptr ? *found : Bid();
+}
+
+/**
+* Number of levels in the tree, a lone leaf is 1
+*/
+int BidBTree::Height() {
+    return levels;
+}
+
+//============================================================================
+// Concurrent tree class definition
+//============================================================================
+
+// reader slots for epoch tracking, threads beyond this share slots
+const unsigned int READER_SLOTS = 64;
+
+// retired nodes a writer lets pile up before waiting out a grace period
+const size_t RETIRE_BATCH = 4096;
+
+/**
+* Define a class containing data members and methods to
+* implement a binary search tree that many threads can read while
+* one thread at a time changes it
+*
+* Nodes are never changed once published. A writer copies the path
+* from the root to the change (rebalancing the copies like the AVL
+* tree does) and swaps in the new root with a single atomic store, so
+* readers never lock and always see a complete tree. Replaced nodes
+* and removed bids are retired and only freed once every reader that
+* could still hold them has left, tracked with two epoch counters per
+* reader slot.
+*/
+class ConcurrentBidTree {
+
+private:
+    // immutable tree node, bids are shared by every copy of their node
+    struct Node {
+        const Bid* bid;
+        const Node* left;
+        const Node* right;
+        int height;
+    };
+
+    // readers active in each epoch parity, one cache line per slot
+    struct alignas(64) ReaderSlot {
+        atomic<long> active[2];
+
+        ReaderSlot() {
+            active[0] = 0;
+            active[1] = 0;
+        }
+    };
+
+    // registration of a reader for the duration of one lookup
+    class ReadGuard {
+        ReaderSlot& slot;
+        unsigned long epoch;
+
+    public:
+        ReadGuard(const ConcurrentBidTree& tree);
+        ~ReadGuard();
+    };
+
+    atomic<const Node*> root;
+    atomic<size_t> count;
+    atomic<unsigned long> epoch;
+    mutable ReaderSlot slots[READER_SLOTS];
+
+    // writer state, guarded by writeLock
+    mutex writeLock;
+    NodePool<Node> nodePool;
+    NodePool<Bid> bidPool;
+    vector<const Node*> retiredNodes;
+    vector<const Bid*> retiredBids;
+
+    const Node* makeNode(const Bid* bid, const Node* left, const Node* right);
+    const Node* balance(const Bid* bid, const Node* left, const Node* right);
+    const Node* addNode(const Node* node, const Bid* bid);
+    const Node* removeNode(const Node* node, string_view bidId, bool& removed);
+    const Node* removeMin(const Node* node, const Bid*& minBid);
+    void retire(const Node* node);
+    void publish(const Node* newRoot);
+    void synchronize();
+
+    static int height(const Node* node);
+    static unsigned int readerSlot();
+
+public:
+    ConcurrentBidTree();
+    virtual ~ConcurrentBidTree();
+    void Insert(Bid bid);
+    void Remove(string_view bidId);
+    Bid Search(string_view bidId) const;
+    template <typename Visitor>
+    bool Visit(string_view bidId, Visitor visit) const;
+    size_t Size() const;
+};
+
+/**
+* Default constructor
+*/
+ConcurrentBidTree::ConcurrentBidTree() {
+    root = nullptr;
+    count = 0;
+    epoch = 0;
+}
+
+/**
+* Destructor, no reader may still be using the tree
+*/
+ConcurrentBidTree::~ConcurrentBidTree() {
+    // nodes hold no strings, the pool frees them with its blocks,
+    // but every bid still alive has to be destroyed
+    for (const Bid* bid : retiredBids) {
+        bidPool.Destroy(const_cast<Bid*>(bid));
+    }
+
+    vector<const Node*> stack;
+    if (root.load() != nullptr) {
+        stack.push_back(root.load());
+    }
+    while (!stack.empty()) {
+        const Node* node = stack.back();
+        stack.pop_back();
+        if (node->left != nullptr) {
+            stack.push_back(node->left);
+        }
+        if (node->right != nullptr) {
+            stack.push_back(node->right);
+        }
+        bidPool.Destroy(const_cast<Bid*>(node->bid));
+    }
+}
+
+/**
+* Slot of the calling thread, fixed for the life of the thread
+*/
+unsigned int ConcurrentBidTree::readerSlot() {
+    static atomic<unsigned int> nextSlot(0);
+    thread_local unsigned int slot = nextSlot++ % READER_SLOTS;
+    return slot;
+}
+
+/**
+* Enter the current epoch
+*
+* The counter is raised before the epoch is checked again, so either
+* a writer flipping the epoch sees this reader or the reader sees the
+* flip and retries in the new epoch. Neither side takes a lock.
+*/
+ConcurrentBidTree::ReadGuard::ReadGuard(const ConcurrentBidTree& tree)
+    : slot(tree.slots[readerSlot()]) {
+    for (;;) {
+        epoch = tree.epoch.load();
+        slot.active[epoch & 1].fetch_add(1);
+        if (tree.epoch.load() == epoch) {
+            return;
+        }
+        slot.active[epoch & 1].fetch_sub(1);
+    }
+}
+
+/**
+* Leave the epoch entered by the constructor
+*/
+ConcurrentBidTree::ReadGuard::~ReadGuard() {
+    slot.active[epoch & 1].fetch_sub(1);
+}
+
+/**
+* Insert a bid
+*/
+void ConcurrentBidTree::Insert(Bid bid) {
+    lock_guard<mutex> lock(writeLock);
+    const Bid* stored = bidPool.Create(move(bid));
+    publish(addNode(root.load(), stored));
+    ++count;
+}
+
+/**
+* Remove a bid
+*/
+void ConcurrentBidTree::Remove(string_view bidId) {
+    lock_guard<mutex> lock(writeLock);
+    bool removed = false;
+    const Node* newRoot = removeNode(root.load(), bidId, removed);
+    if (removed) {
+        publish(newRoot);
+        --count;
+    }
+}
+
+/**
+* Search for a bid
+*
+* @return A copy of the bid, or an empty bid when not found
+*/
+Bid ConcurrentBidTree::Search(string_view bidId) const {
+    Bid bid;
+    Visit(bidId, [&bid](const Bid& found) {
+        bid = found;
+    });
+    return bid;
+}
+
+/**
+* Look up a bid and hand it to a callback without copying it
+*
+* The bid may be removed by a writer as soon as this returns, so the
+* callback must not keep a pointer to it.
+*
+* @param bidId The bid id to search for
+* @param visit Called with the bid when found
+* @return True when the bid was found
+*/
+template <typename Visitor>
+bool ConcurrentBidTree::Visit(string_view bidId, Visitor visit) const {
+    ReadGuard guard(*this);
+
+    const Node* current = root.load(memory_order_acquire);
+    while (current != nullptr) {
+        if (current->bid->bidId == bidId) {
+            visit(*current->bid);
+            return true;
+        }
+        current = bidId < current->bid->bidId ? current->left : current->right;
+    }
+    return false;
+}
+
+/**
+* Number of bids in the tree
+*/
+size_t ConcurrentBidTree::Size() const {
+    return count.load();
+}
+
+/**
+* Allocate a node and compute its height
+*/
+auto ConcurrentBidTree::makeNode(const Bid* bid, const Node* left, const Node* right) -> const Node* {
+    Node* node = nodePool.Create();
+    node->bid = bid;
+    node->left = left;
+    node->right = right;
+    node->height = 1 + max(height(left), height(right));
+    return node;
+}
+
+/**
+* Build a node over two subtrees whose heights differ by at most two,
+* rotating into fresh nodes when they differ by two
+*
+* @param bid Bid of the new node
+* @param left New left subtree
+* @param right New right subtree
+* @return Root of the balanced subtree
+*/
+auto ConcurrentBidTree::balance(const Bid* bid, const Node* left, const Node* right) -> const Node* {
+    int leftHeight = height(left);
+    int rightHeight = height(right);
+
+    if (leftHeight > rightHeight + 1) {
+        retire(left);
+        if (height(left->left) >= height(left->right)) {
+            return makeNode(left->bid, left->left, makeNode(bid, left->right, right));
+        }
+        const Node* middle = left->right;
+        retire(middle);
+        return makeNode(middle->bid, makeNode(left->bid, left->left, middle->left),
+            makeNode(bid, middle->right, right));
+    }
+    if (rightHeight > leftHeight + 1) {
+        retire(right);
+        if (height(right->right) >= height(right->left)) {
+            return makeNode(right->bid, makeNode(bid, left, right->left), right->right);
+        }
+        const Node* middle = right->left;
+        retire(middle);
+        return makeNode(middle->bid, makeNode(bid, left, middle->left),
+            makeNode(right->bid, middle->right, right->right));
+    }
+    return makeNode(bid, left, right);
+}
+
+/**
+* Copy the path to a new leaf (recursive)
+*
+* @return Root of the new version of this subtree
+*/
+auto ConcurrentBidTree::addNode(const Node* node, const Bid* bid) -> const Node* {
+    if (node == nullptr) {
+        return makeNode(bid, nullptr, nullptr);
+    }
+
+    retire(node);
+    if (bid->bidId < node->bid->bidId) {
+        return balance(node->bid, addNode(node->left, bid), node->right);
+    }
+    return balance(node->bid, node->left, addNode(node->right, bid));
+}
+
+/**
+* Copy the path to a removed bid (recursive)
+*
+* @param removed Set when a bid was found and removed
+* @return Root of the new version of this subtree, or the same
+*         subtree when the id was not found below it
+*/
+auto ConcurrentBidTree::removeNode(const Node* node, string_view bidId, bool& removed) -> const Node* {
+    if (node == nullptr) {
+        return nullptr;
+    }
+
+    if (bidId < node->bid->bidId) {
+        const Node* left = removeNode(node->left, bidId, removed);
+        if (!removed) {
+            return node;
+        }
+        retire(node);
+        return balance(node->bid, left, node->right);
+    }
+    if (node->bid->bidId < bidId) {
+        const Node* right = removeNode(node->right, bidId, removed);
+        if (!removed) {
+            return node;
+        }
+        retire(node);
+        return balance(node->bid, node->left, right);
+    }
+
+    removed = true;
+    retire(node);
+    retiredBids.push_back(node->bid);
+    if (node->left == nullptr) {
+        return node->right;
+    }
+    if (node->right == nullptr) {
+        return node->left;
+    }
+
+    // the in-order successor's bid takes this node's place
+    const Bid* successor = nullptr;
+    const Node* right = removeMin(node->right, successor);
+    return balance(successor, node->left, right);
+}
+
+/**
+* Copy the path to the smallest bid of a subtree, leaving it out
+* (recursive)
+*
+* @param minBid Receives the smallest bid
+* @return Root of the new version of this subtree
+*/
+auto ConcurrentBidTree::removeMin(const Node* node, const Bid*& minBid) -> const Node* {
+    retire(node);
+    if (node->left == nullptr) {
+        minBid = node->bid;
+        return node->right;
+    }
+    const Node* left = removeMin(node->left, minBid);
+    return balance(node->bid, left, node->right);
+}
+
+/**
+* Queue a node that the next published version no longer uses
+*/
+void ConcurrentBidTree::retire(const Node* node) {
+    retiredNodes.push_back(node);
+}
+
+/**
+* Make a new version visible to readers, reclaiming old ones in batches
+*/
+void ConcurrentBidTree::publish(const Node* newRoot) {
+    root.store(newRoot, memory_order_release);
+    if (retiredNodes.size() >= RETIRE_BATCH) {
+        synchronize();
+    }
+}
+
+/**
+* Wait until no reader can still see retired nodes, then free them
+*
+* Readers that start after the epoch flips load the new root, so
+* only readers counted under the old parity need to drain.
+*/
+void ConcurrentBidTree::synchronize() {
+    unsigned long oldEpoch = epoch.load();
+    epoch.store(oldEpoch + 1);
+
+    for (ReaderSlot& slot : slots) {
+        while (slot.active[oldEpoch & 1].load() != 0) {
+            this_thread::yield();
+        }
+    }
+
+    for (const Node* node : retiredNodes) {
+        nodePool.Destroy(const_cast<Node*>(node));
+    }
+    for (const Bid* bid : retiredBids) {
+        bidPool.Destroy(const_cast<Bid*>(bid));
+    }
+    retiredNodes.clear();
+    retiredBids.clear();
+}
+
+/**
+* Height of a possibly empty subtree
+*/
+int ConcurrentBidTree::height(const Node* node) {
+    return node == nullptr ? 0 : node->height;
+}
+
+//============================================================================
+// Adaptive radix tree class definition
+//============================================================================
+
+// prefix bytes kept in each radix tree node, longer prefixes are checked at the leaf
+const unsigned int ART_MAX_PREFIX = 8;
+
+enum class ArtType : uint8_t { Leaf, Node4, Node16, Node48, Node256 };
+
+// Header shared by every radix tree node. The prefix holds the bytes all
+// keys below the node share past the parent's branch byte.
+struct ArtNode {
+    ArtType type;
+    uint16_t count;
+    uint32_t prefixLen;
+    unsigned char prefix[ART_MAX_PREFIX];
+
+    ArtNode(ArtType nodeType) {
+        type = nodeType;
+        count = 0;
+        prefixLen = 0;
+    }
+};
+
+// Leaf holding a bid, later bids with the same id are chained behind it
+struct ArtLeaf : ArtNode {
+    Bid bid;
+    ArtLeaf* duplicate;
+
+    ArtLeaf(Bid aBid) : ArtNode(ArtType::Leaf) {
+        bid = move(aBid);
+        duplicate = nullptr;
+    }
+};
+
+// Up to 4 children, branch bytes kept sorted
+struct ArtNode4 : ArtNode {
+    unsigned char keys[4];
+    ArtNode* children[4];
+
+    ArtNode4() : ArtNode(ArtType::Node4) {
+    }
+};
+
+// Up to 16 children, branch bytes kept sorted and matched 16 at a time
+struct ArtNode16 : ArtNode {
+    unsigned char keys[16];
+    ArtNode* children[16];
+
+    ArtNode16() : ArtNode(ArtType::Node16) {
+    }
+};
+
+// Up to 48 children, childIndex maps a byte to its slot plus one
+struct ArtNode48 : ArtNode {
+    unsigned char childIndex[256];
+    ArtNode* children[48];
+
+    ArtNode48() : ArtNode(ArtType::Node48) {
+        fill(begin(childIndex), end(childIndex), 0);
+        fill(begin(children), end(children), nullptr);
+    }
+};
+
+// One child slot per byte value
+struct ArtNode256 : ArtNode {
+    ArtNode* children[256];
+
+    ArtNode256() : ArtNode(ArtType::Node256) {
+        fill(begin(children), end(children), nullptr);
+    }
+};
+
+/**
+* Define a class containing data members and methods to
+* implement an adaptive radix tree of bids
+*
+* Ids are walked a byte at a time, so a lookup costs about the id
+* length instead of a string comparison per tree level. Runs of bytes
+* shared by every id below a node are stored once in that node, and
+* each node uses the smallest of four layouts that fits its children.
+* It offers the same operations as BinarySearchTree.
+*
+* Ids are terminated by a zero byte, so they must not contain one.
+*/
+class BidRadixTree {
+
+private:
+    ArtNode* root;
+    size_t count;
+    NodePool<ArtLeaf> leafPool;
+    NodePool<ArtNode4> node4Pool;
+    NodePool<ArtNode16> node16Pool;
+    NodePool<ArtNode48> node48Pool;
+    NodePool<ArtNode256> node256Pool;
+
+    void insert(ArtNode*& ref, ArtLeaf* leaf, string_view key, size_t depth);
+    ArtLeaf* remove(ArtNode*& ref, string_view key, size_t depth);
+    void addChild(ArtNode*& ref, ArtNode* node, unsigned char byte, ArtNode* child);
+    void removeChild(ArtNode*& ref, ArtNode* node, unsigned char byte, ArtNode** slot);
+    size_t prefixMismatch(const ArtNode* node, string_view key, size_t depth) const;
+    void inOrder(const ArtNode* node) const;
+    void destroy(ArtNode* node);
+    void freeNode(ArtNode* node);
+
+    static unsigned char keyByte(string_view key, size_t depth);
+    static ArtNode** findChild(ArtNode* node, unsigned char byte);
+    static size_t checkPrefix(const ArtNode* node, string_view key, size_t depth);
+    static const ArtLeaf* minimum(const ArtNode* node);
+    static void copyHeader(ArtNode* to, const ArtNode* from);
+
+public:
+    BidRadixTree();
+    virtual ~BidRadixTree();
+    void InOrder();
+    void Insert(const Bid& bid);
+    void Insert(Bid&& bid);
+    void Remove(string_view bidId);
+    const Bid* Find(string_view bidId) const;
+    Bid Search(string_view bidId) const;
+    size_t Size() const;
+    size_t MemoryUsage() const;
+};
+
+/**
+* Default constructor
+*/
+BidRadixTree::BidRadixTree() {
+    root = nullptr;
+    count = 0;
+}
+
+/**
+* Destructor
+*/
+BidRadixTree::~BidRadixTree() {
+    destroy(root);
+}
+
+/**
+* Byte of a key at some depth, the zero terminator past its end
+*/
+unsigned char BidRadixTree::keyByte(string_view key, size_t depth) {
+    return depth < key.size() ? static_cast<unsigned char>(key[depth]) : 0;
+}
+
+/**
+* Slot holding the child for a branch byte
+*
+* @return The slot, or nullptr when there is no such child
+*/
+ArtNode** BidRadixTree::findChild(ArtNode* node, unsigned char byte) {
+    switch (node->type) {
+    case ArtType::Node4: {
+        ArtNode4* node4 = static_cast<ArtNode4*>(node);
+        for (int i = 0; i < node4->count; ++i) {
+            if (node4->keys[i] == byte) {
+                return &node4->children[i];
+            }
+        }
+        return nullptr;
+    }
+    case ArtType::Node16: {
+        ArtNode16* node16 = static_cast<ArtNode16*>(node);
+#if defined(__SSE2__) || defined(_M_X64)
+        // compare all 16 branch bytes at once
+        __m128i matches = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(node16->keys)));
+        unsigned int mask = _mm_movemask_epi8(matches) & ((1u << node16->count) - 1);
+        if (mask != 0) {
+            int index = 0;
+            while ((mask & 1) == 0) {
+                mask >>= 1;
+                ++index;
+            }
+            return &node16->children[index];
+        }
+#else
+        for (int i = 0; i < node16->count; ++i) {
+            if (node16->keys[i] == byte) {
+                return &node16->children[i];
+            }
+        }
+#endif
+        return nullptr;
+    }
+    case ArtType::Node48: {
+        ArtNode48* node48 = static_cast<ArtNode48*>(node);
+        int index = node48->childIndex[byte];
+        return index != 0 ? &node48->children[index - 1] : nullptr;
+    }
+    case ArtType::Node256: {
+        ArtNode256* node256 = static_cast<ArtNode256*>(node);
+        return node256->children[byte] != nullptr ? &node256->children[byte] : nullptr;
+    }
+    default:
+        return nullptr;
+    }
+}
+
+/**
+* Number of stored prefix bytes of a node that match the key
+*/
+size_t BidRadixTree::checkPrefix(const ArtNode* node, string_view key, size_t depth) {
+    size_t stored = min<size_t>(node->prefixLen, ART_MAX_PREFIX);
+    for (size_t i = 0; i < stored; ++i) {
+        if (node->prefix[i] != keyByte(key, depth + i)) {
+            return i;
+        }
+    }
+    return stored;
+}
+
+/**
+* Number of prefix bytes of a node that match the key, reading the
+* bytes past the stored ones from the node's smallest leaf
+*/
+size_t BidRadixTree::prefixMismatch(const ArtNode* node, string_view key, size_t depth) const {
+    size_t matched = checkPrefix(node, key, depth);
+    if (matched < ART_MAX_PREFIX || node->prefixLen <= ART_MAX_PREFIX) {
+        return matched;
+    }
+
+    string_view leafKey = minimum(node)->bid.bidId;
+    while (matched < node->prefixLen
+        && keyByte(leafKey, depth + matched) == keyByte(key, depth + matched)) {
+        ++matched;
+    }
+    return matched;
+}
+
+/**
+* Leaf with the smallest key below a node
+*/
+const ArtLeaf* BidRadixTree::minimum(const ArtNode* node) {
+    while (node->type != ArtType::Leaf) {
+        switch (node->type) {
+        case ArtType::Node4:
+            node = static_cast<const ArtNode4*>(node)->children[0];
+            break;
+        case ArtType::Node16:
+            node = static_cast<const ArtNode16*>(node)->children[0];
+            break;
+        case ArtType::Node48: {
+            const ArtNode48* node48 = static_cast<const ArtNode48*>(node);
+            int byte = 0;
+            while (node48->childIndex[byte] == 0) {
+                ++byte;
+            }
+            node = node48->children[node48->childIndex[byte] - 1];
+            break;
+        }
+        default: {
+            const ArtNode256* node256 = static_cast<const ArtNode256*>(node);
+            int byte = 0;
+            while (node256->children[byte] == nullptr) {
+                ++byte;
+            }
+            node = node256->children[byte];
+            break;
+        }
+        }
+    }
+    return static_cast<const ArtLeaf*>(node);
+}
+
+/**
+* Copy the child count and prefix when a node changes layout
+*/
+void BidRadixTree::copyHeader(ArtNode* to, const ArtNode* from) {
+    to->count = from->count;
+    to->prefixLen = from->prefixLen;
+    copy(begin(from->prefix), end(from->prefix), begin(to->prefix));
+}
+
+/**
+* Traverse the tree in order
+*/
+void BidRadixTree::InOrder() {
+    inOrder(root);
+}
+
+/**
+* Print the bids below a node in byte order (recursive, depth is at
+* most the id length)
+*/
+void BidRadixTree::inOrder(const ArtNode* node) const {
+    if (node == nullptr) {
+        return;
+    }
+
+    switch (node->type) {
+    case ArtType::Leaf:
+        for (const ArtLeaf* leaf = static_cast<const ArtLeaf*>(node); leaf != nullptr; leaf = leaf->duplicate) {
+            cout << leaf->bid.bidId << ": " << leaf->bid.title << " | "
+                << leaf->bid.amount << " | " << leaf->bid.fund << endl;
+        }
+        break;
+    case ArtType::Node4:
+        for (int i = 0; i < node->count; ++i) {
+            inOrder(static_cast<const ArtNode4*>(node)->children[i]);
+        }
+        break;
+    case ArtType::Node16:
+        for (int i = 0; i < node->count; ++i) {
+            inOrder(static_cast<const ArtNode16*>(node)->children[i]);
+        }
+        break;
+    case ArtType::Node48: {
+        const ArtNode48* node48 = static_cast<const ArtNode48*>(node);
+        for (int byte = 0; byte < 256; ++byte) {
+            if (node48->childIndex[byte] != 0) {
+                inOrder(node48->children[node48->childIndex[byte] - 1]);
+            }
+        }
+        break;
+    }
+    case ArtType::Node256:
+        for (int byte = 0; byte < 256; ++byte) {
+            inOrder(static_cast<const ArtNode256*>(node)->children[byte]);
+        }
+        break;
+    }
+}
+
+/**
+* Insert a copy of a bid
+*/
+void BidRadixTree::Insert(const Bid& bid) {
+    Insert(Bid(bid));
+}
+
+/**
+* Insert a bid, moving its strings into the tree
+*/
+void BidRadixTree::Insert(Bid&& bid) {
+    ArtLeaf* leaf = leafPool.Create(move(bid));
+    insert(root, leaf, leaf->bid.bidId, 0);
+    ++count;
+}
+
+/**
+* Add a leaf below some node (recursive)
+*
+* @param ref Slot pointing at the node, updated when the node is
+*            split or replaced by a larger layout
+* @param leaf The new leaf
+* @param key Id of the new leaf
+* @param depth Number of key bytes consumed above this node
+*/
+void BidRadixTree::insert(ArtNode*& ref, ArtLeaf* leaf, string_view key, size_t depth) {
+    ArtNode* node = ref;
+    if (node == nullptr) {
+        ref = leaf;
+        return;
+    }
+
+    if (node->type == ArtType::Leaf) {
+        ArtLeaf* existing = static_cast<ArtLeaf*>(node);
+        string_view existingKey = existing->bid.bidId;
+
+        // same id, keep insertion order behind the existing leaf
+        if (existingKey == key) {
+            while (existing->duplicate != nullptr) {
+                existing = existing->duplicate;
+            }
+            existing->duplicate = leaf;
+            return;
+        }
+
+        // split the leaf with a node holding the bytes both ids share
+        ArtNode4* split = node4Pool.Create();
+        size_t common = 0;
+        while (keyByte(existingKey, depth + common) == keyByte(key, depth + common)) {
+            if (common < ART_MAX_PREFIX) {
+                split->prefix[common] = keyByte(key, depth + common);
+            }
+            ++common;
+        }
+        split->prefixLen = static_cast<uint32_t>(common);
+
+        ArtNode* splitRef = split;
+        addChild(splitRef, split, keyByte(existingKey, depth + common), existing);
+        addChild(splitRef, split, keyByte(key, depth + common), leaf);
+        ref = split;
+        return;
+    }
+
+    if (node->prefixLen > 0) {
+        size_t matched = prefixMismatch(node, key, depth);
+        if (matched < node->prefixLen) {
+            // the key leaves the shared prefix early, split the prefix there
+            ArtNode4* split = node4Pool.Create();
+            split->prefixLen = static_cast<uint32_t>(matched);
+            copy(node->prefix, node->prefix + min<size_t>(matched, ART_MAX_PREFIX), split->prefix);
+
+            ArtNode* splitRef = split;
+            if (node->prefixLen <= ART_MAX_PREFIX) {
+                addChild(splitRef, split, node->prefix[matched], node);
+                node->prefixLen -= static_cast<uint32_t>(matched + 1);
+                copy(node->prefix + matched + 1, node->prefix + matched + 1 + node->prefixLen, node->prefix);
+            }
+            else {
+                // the bytes past the stored prefix come from a leaf
+                string_view leafKey = minimum(node)->bid.bidId;
+                addChild(splitRef, split, keyByte(leafKey, depth + matched), node);
+                node->prefixLen -= static_cast<uint32_t>(matched + 1);
+                for (size_t i = 0; i < min<size_t>(node->prefixLen, ART_MAX_PREFIX); ++i) {
+                    node->prefix[i] = keyByte(leafKey, depth + matched + 1 + i);
+                }
+            }
+            addChild(splitRef, split, keyByte(key, depth + matched), leaf);
+            ref = split;
+            return;
+        }
+        depth += node->prefixLen;
+    }
+
+    ArtNode** child = findChild(node, keyByte(key, depth));
+    if (child != nullptr) {
+        insert(*child, leaf, key, depth + 1);
+        return;
+    }
+    addChild(ref, node, keyByte(key, depth), leaf);
+}
+
+/**
+* Add a child to a node, moving to the next larger layout when full
+*
+* @param ref Slot pointing at the node, updated if it grows
+*/
+void BidRadixTree::addChild(ArtNode*& ref, ArtNode* node, unsigned char byte, ArtNode* child) {
+    switch (node->type) {
+    case ArtType::Node4: {
+        ArtNode4* node4 = static_cast<ArtNode4*>(node);
+        if (node4->count < 4) {
+            int index = 0;
+            while (index < node4->count && node4->keys[index] < byte) {
+                ++index;
+            }
+            for (int i = node4->count; i > index; --i) {
+                node4->keys[i] = node4->keys[i - 1];
+                node4->children[i] = node4->children[i - 1];
+            }
+            node4->keys[index] = byte;
+            node4->children[index] = child;
+            ++node4->count;
+            return;
+        }
+        ArtNode16* grown = node16Pool.Create();
+        copyHeader(grown, node4);
+        copy(node4->keys, node4->keys + 4, grown->keys);
+        copy(node4->children, node4->children + 4, grown->children);
+        node4Pool.Destroy(node4);
+        ref = grown;
+        addChild(ref, grown, byte, child);
+        return;
+    }
+    case ArtType::Node16: {
+        ArtNode16* node16 = static_cast<ArtNode16*>(node);
+        if (node16->count < 16) {
+            int index = 0;
+            while (index < node16->count && node16->keys[index] < byte) {
+                ++index;
+            }
+            for (int i = node16->count; i > index; --i) {
+                node16->keys[i] = node16->keys[i - 1];
+                node16->children[i] = node16->children[i - 1];
+            }
+            node16->keys[index] = byte;
+            node16->children[index] = child;
+            ++node16->count;
+            return;
+        }
+        ArtNode48* grown = node48Pool.Create();
+        copyHeader(grown, node16);
+        for (int i = 0; i < 16; ++i) {
+            grown->childIndex[node16->keys[i]] = static_cast<unsigned char>(i + 1);
+            grown->children[i] = node16->children[i];
+        }
+        node16Pool.Destroy(node16);
+        ref = grown;
+        addChild(ref, grown, byte, child);
+        return;
+    }
+    case ArtType::Node48: {
+        ArtNode48* node48 = static_cast<ArtNode48*>(node);
+        if (node48->count < 48) {
+            int slot = 0;
+            while (node48->children[slot] != nullptr) {
+                ++slot;
+            }
+            node48->children[slot] = child;
+            node48->childIndex[byte] = static_cast<unsigned char>(slot + 1);
+            ++node48->count;
+            return;
+        }
+        ArtNode256* grown = node256Pool.Create();
+        copyHeader(grown, node48);
+        for (int b = 0; b < 256; ++b) {
+            if (node48->childIndex[b] != 0) {
+                grown->children[b] = node48->children[node48->childIndex[b] - 1];
+            }
+        }
+        node48Pool.Destroy(node48);
+        ref = grown;
+        addChild(ref, grown, byte, child);
+        return;
+    }
+    case ArtType::Node256: {
+        ArtNode256* node256 = static_cast<ArtNode256*>(node);
+        node256->children[byte] = child;
+        ++node256->count;
+        return;
+    }
+    default:
+        return;
+    }
+}
+
+/**
+* Remove a bid
+*/
+void BidRadixTree::Remove(string_view bidId) {
+    ArtLeaf* leaf = remove(root, bidId, 0);
+    if (leaf != nullptr) {
+        leafPool.Destroy(leaf);
+        --count;
+    }
+}
+
+/**
+* Unlink the first leaf with an id below some node (recursive)
+*
+* @param ref Slot pointing at the node, updated if it shrinks
+* @param key Id to remove
+* @param depth Number of key bytes consumed above this node
+* @return The unlinked leaf, or nullptr when the id was not found
+*/
+ArtLeaf* BidRadixTree::remove(ArtNode*& ref, string_view key, size_t depth) {
+    ArtNode* node = ref;
+    if (node == nullptr) {
+        return nullptr;
+    }
+
+    // only a root can be a bare leaf here
+    if (node->type == ArtType::Leaf) {
+        ArtLeaf* leaf = static_cast<ArtLeaf*>(node);
+        if (leaf->bid.bidId != key) {
+            return nullptr;
+        }
+        ref = leaf->duplicate;
+        return leaf;
+    }
+
+    if (node->prefixLen > 0) {
+        if (checkPrefix(node, key, depth) != min<size_t>(node->prefixLen, ART_MAX_PREFIX)) {
+            return nullptr;
+        }
+        depth += node->prefixLen;
+    }
+
+    unsigned char byte = keyByte(key, depth);
+    ArtNode** child = findChild(node, byte);
+    if (child == nullptr) {
+        return nullptr;
+    }
+
+    if ((*child)->type != ArtType::Leaf) {
+        return remove(*child, key, depth + 1);
+    }
+
+    ArtLeaf* leaf = static_cast<ArtLeaf*>(*child);
+    if (leaf->bid.bidId != key) {
+        return nullptr;
+    }
+    if (leaf->duplicate != nullptr) {
+        *child = leaf->duplicate;
+    }
+    else {
+        removeChild(ref, node, byte, child);
+    }
+    return leaf;
+}
+
+/**
+* Drop a child from a node, moving to the next smaller layout once it
+* is well under capacity and folding a Node4 with one child into it
+*
+* @param ref Slot pointing at the node, updated if it shrinks
+* @param slot Slot of the child being dropped
+*/
+void BidRadixTree::removeChild(ArtNode*& ref, ArtNode* node, unsigned char byte, ArtNode** slot) {
+    switch (node->type) {
+    case ArtType::Node4: {
+        ArtNode4* node4 = static_cast<ArtNode4*>(node);
+        int index = int(slot - node4->children);
+        for (int i = index; i < node4->count - 1; ++i) {
+            node4->keys[i] = node4->keys[i + 1];
+            node4->children[i] = node4->children[i + 1];
+        }
+        --node4->count;
+
+        if (node4->count == 1) {
+            // the lone child takes this node's place, inheriting its
+            // prefix and branch byte ahead of its own prefix
+            ArtNode* child = node4->children[0];
+            if (child->type != ArtType::Leaf) {
+                size_t length = node4->prefixLen;
+                if (length < ART_MAX_PREFIX) {
+                    node4->prefix[length++] = node4->keys[0];
+                }
+                for (size_t i = 0; length < ART_MAX_PREFIX && i < child->prefixLen; ++i) {
+                    node4->prefix[length++] = child->prefix[i];
+                }
+                copy(node4->prefix, node4->prefix + min<size_t>(length, ART_MAX_PREFIX), child->prefix);
+                child->prefixLen += node4->prefixLen + 1;
+            }
+            node4Pool.Destroy(node4);
+            ref = child;
+        }
+        return;
+    }
+    case ArtType::Node16: {
+        ArtNode16* node16 = static_cast<ArtNode16*>(node);
+        int index = int(slot - node16->children);
+        for (int i = index; i < node16->count - 1; ++i) {
+            node16->keys[i] = node16->keys[i + 1];
+            node16->children[i] = node16->children[i + 1];
+        }
+        --node16->count;
+
+        if (node16->count == 3) {
+            ArtNode4* shrunk = node4Pool.Create();
+            copyHeader(shrunk, node16);
+            copy(node16->keys, node16->keys + 3, shrunk->keys);
+            copy(node16->children, node16->children + 3, shrunk->children);
+            node16Pool.Destroy(node16);
+            ref = shrunk;
+        }
+        return;
+    }
+    case ArtType::Node48: {
+        ArtNode48* node48 = static_cast<ArtNode48*>(node);
+        node48->children[node48->childIndex[byte] - 1] = nullptr;
+        node48->childIndex[byte] = 0;
+        --node48->count;
+
+        if (node48->count == 12) {
+            ArtNode16* shrunk = node16Pool.Create();
+            copyHeader(shrunk, node48);
+            int next = 0;
+            for (int b = 0; b < 256; ++b) {
+                if (node48->childIndex[b] != 0) {
+                    shrunk->keys[next] = static_cast<unsigned char>(b);
+                    shrunk->children[next++] = node48->children[node48->childIndex[b] - 1];
+                }
+            }
+            node48Pool.Destroy(node48);
+            ref = shrunk;
+        }
+        return;
+    }
+    case ArtType::Node256: {
+        ArtNode256* node256 = static_cast<ArtNode256*>(node);
+        node256->children[byte] = nullptr;
+        --node256->count;
+
+        if (node256->count == 37) {
+            ArtNode48* shrunk = node48Pool.Create();
+            copyHeader(shrunk, node256);
+            int next = 0;
+            for (int b = 0; b < 256; ++b) {
+                if (node256->children[b] != nullptr) {
+                    shrunk->children[next] = node256->children[b];
+                    shrunk->childIndex[b] = static_cast<unsigned char>(++next);
+                }
+            }
+            node256Pool.Destroy(node256);
+            ref = shrunk;
+        }
+        return;
+    }
+    default:
+        return;
+    }
+}
+
+/**
+* Find a bid without copying it
+*
+* Only the stored prefix bytes are checked on the way down; the full
+* id is compared once at the leaf.
+*
+* @param bidId The bid id to search for
+* @return The stored bid, or nullptr when not found
+*/
+const Bid* BidRadixTree::Find(string_view bidId) const {
+    ArtNode* node = root;
+    size_t depth = 0;
+
+    while (node != nullptr) {
+        if (node->type == ArtType::Leaf) {
+            const ArtLeaf* leaf = static_cast<const ArtLeaf*>(node);
+            return leaf->bid.bidId == bidId ? &leaf->bid : nullptr;
+        }
+        if (node->prefixLen > 0) {
+            if (checkPrefix(node, bidId, depth) != min<size_t>(node->prefixLen, ART_MAX_PREFIX)) {
+                return nullptr;
+            }
+            depth += node->prefixLen;
+        }
+        ArtNode** child = findChild(node, keyByte(bidId, depth));
+        node = child != nullptr ? *child : nullptr;
+        ++depth;
+    }
+    return nullptr;
+}
+
+/**
+* Search for a bid
+*
+* @return A copy of the bid, or an empty bid when not found
+*/
+Bid BidRadixTree::Search(string_view bidId) const {
+    const Bid* found = Find(bidId);
+    return found != nullptr ? *found : Bid();
+}
+
+/**
+* Number of bids in the tree
+*/
+size_t BidRadixTree::Size() const {
+    return count;
+}
+
+/**
+* Bytes taken by the live leaves and inner nodes, not counting the
+* heap buffers of long bid strings
+*/
+size_t BidRadixTree::MemoryUsage() const {
+    const NodePoolStats* pools[] = { &leafPool.GetStats(), &node4Pool.GetStats(),
+        &node16Pool.GetStats(), &node48Pool.GetStats(), &node256Pool.GetStats() };
+    size_t bytes = 0;
+    for (const NodePoolStats* stats : pools) {
+        bytes += stats->liveNodes * stats->nodeBytes;
+    }
+    return bytes;
+}
+
+/**
+* Destroy a subtree (recursive, depth is at most the id length)
+*/
+void BidRadixTree::destroy(ArtNode* node) {
+    if (node == nullptr) {
+        return;
+    }
+
+    switch (node->type) {
+    case ArtType::Leaf: {
+        ArtLeaf* leaf = static_cast<ArtLeaf*>(node);
+        while (leaf != nullptr) {
+            ArtLeaf* next = leaf->duplicate;
+            leafPool.Destroy(leaf);
+            leaf = next;
+        }
+        return;
+    }
+    case ArtType::Node4:
+        for (int i = 0; i < node->count; ++i) {
+            destroy(static_cast<ArtNode4*>(node)->children[i]);
+        }
+        break;
+    case ArtType::Node16:
+        for (int i = 0; i < node->count; ++i) {
+            destroy(static_cast<ArtNode16*>(node)->children[i]);
+        }
+        break;
+    case ArtType::Node48:
+        for (ArtNode* child : static_cast<ArtNode48*>(node)->children) {
+            destroy(child);
+        }
+        break;
+    case ArtType::Node256:
+        for (ArtNode* child : static_cast<ArtNode256*>(node)->children) {
+            destroy(child);
+        }
+        break;
+    }
+    freeNode(node);
+}
+
+/**
+* Return an inner node to its pool
+*/
+void BidRadixTree::freeNode(ArtNode* node) {
+    switch (node->type) {
+    case ArtType::Node4:
+        node4Pool.Destroy(static_cast<ArtNode4*>(node));
+        break;
+    case ArtType::Node16:
+        node16Pool.Destroy(static_cast<ArtNode16*>(node));
+        break;
+    case ArtType::Node48:
+        node48Pool.Destroy(static_cast<ArtNode48*>(node));
+        break;
+    case ArtType::Node256:
+        node256Pool.Destroy(static_cast<ArtNode256*>(node));
+        break;
+    default:
+        break;
+    }
+}
+
+//============================================================================
+// Static methods used for testing
+//============================================================================
+
+/**
+* Display the bid information to the console (std::out)
+*
+* @param bid struct containing the bid info
+*/
+void displayBid(const Bid& bid) {
+    cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
+        << bid.fund << endl;
+}
+
+/**
+* Display node allocator statistics to the console (std::out)
+*
+* @param stats Statistics reported by a NodePool
+*/
+void displayPoolStats(const NodePoolStats& stats) {
+    cout << "blocks: " << stats.blocks << " | live nodes: " << stats.liveNodes
+        << " | free nodes: " << stats.freeNodes << " | bytes: " << stats.bytes
+        << " | node size: " << stats.nodeBytes << endl;
+}
+
+/**
+* Prompt for an id range and display the bids in it along with their
+* count and total amount
+*
+* @param bst The tree to report on
+*/
+template <typename Tree>
+void rangeReport(Tree* bst) {
+    string low, high;
+    cout << "Enter first id: ";
+    cin >> low;
+    cout << "Enter id past the end: ";
+    cin >> high;
+
+    for (const Bid* bid : bst->Range(low, high)) {
+        displayBid(*bid);
+    }
+
+    // count and total come from the subtree sums, not the listing
+    clock_t ticks = clock();
+    size_t count = bst->CountRange(low, high);
+    double total = bst->SumRange(low, high);
+    ticks = clock() - ticks;
+
+    cout << count << " bids in [" << low << ", " << high << ") totaling " << total << endl;
+    if (count > 0) {
+        cout << "first is #" << bst->Rank(low) + 1 << " of " << bst->Size() << " by id" << endl;
+    }
+    cout << "time: " << ticks << " clock ticks" << endl;
+    cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+}
+
+/**
+* Display bloom filter statistics to the console (std::out)
+*
+* @param stats Statistics reported by a bloom filter
+*/
+void displayFilterStats(const BloomFilterStats& stats) {
+    unsigned long long misses = stats.rejected + stats.falsePositives;
+    cout << "filter: " << stats.keys << " of " << stats.capacity << " ids | "
+        << stats.bitsPerKey << " bits per id | " << stats.bytes << " bytes" << endl;
+    cout << "lookups: " << stats.queries << " | ruled out: " << stats.rejected
+        << " | false positives: " << stats.falsePositives << " ("
+        << (misses > 0 ? 100.0 * stats.falsePositives / misses : 0.0) << "% of misses)" << endl;
+}
+
+/**
+* Load a CSV file containing bids into a container
+*
+* @param csvPath the path to the CSV file to load
+* @return a container holding all the bids read
+*/
+template <typename Tree>
+void loadBids(string csvPath, Tree* bst) {
+    cout << "Loading CSV file " << csvPath << endl;
+
+    // initialize the CSV Parser using the given path
+    csv::Parser file = csv::Parser(csvPath);
+
+    // read and display header row - optional
+    vector<string> header = file.getHeader();
+    for (auto const& c : header) {
+        cout << c << " | ";
+    }
+    cout << "" << endl;
+
+    vector<Bid> bids;
+    bids.reserve(file.rowCount());
+
+    try {
+        // loop to read rows of a CSV file
+        for (unsigned int i = 0; i < file.rowCount(); i++) {
+
+            // Create a data structure and add to the collection of bids
+            Bid bid;
+            bid.bidId = file[i][1];
+            bid.title = file[i][0];
+            bid.fund = file[i][8];
+            bid.amount = strToDouble(file[i][4], '$');
 
-    // initialize with a bid
-    Node(Bid aBid) : Node() {
-        bid = aBid;
+            // push this bid to the end
+            bids.push_back(move(bid));
+        }
+    }
+    catch (csv::Error& e) {
+        std::cerr << e.what() << std::endl;
     }
-};
 
-//============================================================================
-// Binary Search Tree class definition
-//============================================================================
+    // build the tree from every row read in one pass
+    bst->BulkLoad(move(bids));
+}
 
 /**
-* Define a class containing data members and methods to
-* implement a binary search tree
+* Write every bid in a tree to a snapshot file
+*
+* @param bst The tree to save
+* @param path File to write
+* @param sequence Last change log record the tree includes
 */
-class BinarySearchTree {
+template <typename Tree>
+void saveSnapshot(Tree* bst, const string& path, uint64_t sequence = 0) {
+    vector<const Bid*> bids;
+    bids.reserve(bst->Size());
+    for (const Bid& bid : *bst) {
+        bids.push_back(&bid);
+    }
+    MappedBids::Write(path, move(bids), sequence);
+}
 
-private:
-    Node* root;
+/**
+* Save a snapshot of a tree and empty its change log, so recovery
+* only replays changes made after this point
+*
+* @param bst The tree to save
+* @param log The tree's change log
+* @param snapshotPath File to write
+*/
+template <typename Tree>
+void checkpoint(Tree* bst, BidLog* log, const string& snapshotPath) {
+    saveSnapshot(bst, snapshotPath, log->Sequence());
+    log->Reset();
+}
 
-    void addNode(Node* node, Bid bid);
-    void inOrder(Node* node);
-    Node* removeNode(Node* node, string bidId);
+/**
+* Rebuild a tree from its last snapshot and the changes logged after
+* it, instead of reloading the CSV file
+*
+* @param bst The tree to fill
+* @param snapshotPath Snapshot file, may be missing
+* @param logPath Change log file, may be missing
+* @return Sequence number of the last change applied
+*/
+template <typename Tree>
+uint64_t recoverBids(Tree* bst, const string& snapshotPath, const string& logPath) {
+    MappedBids snapshot;
+    if (ifstream(snapshotPath).good()) {
+        snapshot.Open(snapshotPath);
+        vector<Bid> bids(snapshot.Size());
+        for (size_t i = 0; i < bids.size(); ++i) {
+            MappedBids::BidView view = snapshot.At(i);
+            bids[i].bidId = string(view.bidId);
+            bids[i].title = string(view.title);
+            bids[i].fund = string(view.fund);
+            bids[i].amount = view.amount;
+        }
+        bst->BulkLoad(move(bids));
+    }
 
-public:
-    BinarySearchTree();
-    virtual ~BinarySearchTree();
-    void InOrder();
-    void Insert(Bid bid);
-    void Remove(string bidId);
-    Bid Search(string bidId);
-};
+    unsigned int changes = 0;
+    uint64_t sequence = BidLog::Replay<Bid>(logPath, snapshot.Sequence(),
+        [bst, &changes](Bid&& bid) {
+            bst->Insert(move(bid));
+            ++changes;
+        },
+        [bst, &changes](string_view bidId) {
+            bst->Remove(bidId);
+            ++changes;
+        });
+
+    if (snapshot.Size() > 0 || changes > 0) {
+        cout << snapshot.Size() << " bids recovered from " << snapshotPath << ", "
+            << changes << " changes replayed from " << logPath << endl;
+    }
+    return sequence;
+}
 
 /**
-* Default constructor
+* Simple C function to convert a string to a double
+* after stripping out unwanted char
+*
+* credit: http://stackoverflow.com/a/24875936
+*
+* @param ch The character to strip out
 */
-BinarySearchTree::BinarySearchTree() {
-    // initialize housekeeping variables
-    root = nullptr;
+double strToDouble(string str, char ch) {
+    str.erase(remove(str.begin(), str.end(), ch), str.end());
+    return atof(str.c_str());
 }
 
+//============================================================================
+// Benchmarks
+//============================================================================
+
+// order in which synthetic bid ids are generated
+enum class IdOrder { Sorted, Reversed, Random };
+
 /**
-* Destructor
+* Build synthetic bids with unique ids in the requested order
+*
+* Ids are fixed width so string order matches numeric order.
+*
+* @param count Number of bids to build
+* @param order Order of the generated ids
+* @return The generated bids
 */
-BinarySearchTree::~BinarySearchTree() {
-    // Recurse from root deleting every node
-    while (root != nullptr) {
-        Remove(root->bid.bidId);
+vector<Bid> makeBids(unsigned int count, IdOrder order) {
+    vector<Bid> bids(count);
+    for (unsigned int i = 0; i < count; ++i) {
+        bids[i].bidId = to_string(10000000 + i);
+        bids[i].title = "Benchmark bid " + to_string(i);
+        bids[i].fund = "General Fund";
+        bids[i].amount = i % 1000;
+    }
+
+    if (order == IdOrder::Reversed) {
+        reverse(bids.begin(), bids.end());
+    }
+    else if (order == IdOrder::Random) {
+        mt19937 rng(300);
+        shuffle(bids.begin(), bids.end(), rng);
     }
+    return bids;
 }
 
 /**
-* Traverse the tree in order
+* Time loading and searching a tree with sorted, reverse sorted
+* and random id orders, reporting the resulting height
+*
+* @param count Number of bids to load for each order
 */
-void BinarySearchTree::InOrder() {
-    // In order traversal from root
-    inOrder(root);
-}
+void benchmarkLoadOrders(unsigned int count) {
+    const char* names[] = { "sorted", "reverse", "random" };
+    IdOrder orders[] = { IdOrder::Sorted, IdOrder::Reversed, IdOrder::Random };
 
-void BinarySearchTree::inOrder(Node* node) {
-    //FixMe (3b)
-    if (node != nullptr) {
-        inOrder(node->left);
-        cout << node->bid.bidId << ": " << node->bid.title << " | "
-            << node->bid.amount << " | " << node->bid.fund << endl;
-        inOrder(node->right);
+    for (int i = 0; i < 3; ++i) {
+        vector<Bid> bids = makeBids(count, orders[i]);
+        BinarySearchTree* tree = new BinarySearchTree();
+
+        clock_t ticks = clock();
+        for (const Bid& bid : bids) {
+            tree->Insert(bid);
+        }
+        ticks = clock() - ticks;
+        double loadSeconds = ticks * 1.0 / CLOCKS_PER_SEC;
+
+        ticks = clock();
+        unsigned int found = 0;
+        for (const Bid& bid : bids) {
+            if (tree->Find(bid.bidId) != nullptr) {
+                ++found;
+            }
+        }
+        ticks = clock() - ticks;
+        double searchSeconds = ticks * 1.0 / CLOCKS_PER_SEC;
+
+        cout << names[i] << ": " << count << " bids, height " << tree->Height()
+            << " | load " << loadSeconds << " seconds"
+            << " | search " << searchSeconds << " seconds (" << found << " found)" << endl;
+        displayPoolStats(tree->AllocatorStats());
+
+        ticks = clock();
+        delete tree;
+        ticks = clock() - ticks;
+        double teardownSeconds = ticks * 1.0 / CLOCKS_PER_SEC;
+
+        tree = new BinarySearchTree();
+        ticks = clock();
+        tree->BulkLoad(bids);
+        ticks = clock() - ticks;
+        double bulkSeconds = ticks * 1.0 / CLOCKS_PER_SEC;
+
+        cout << names[i] << ": bulk load " << bulkSeconds << " seconds, height "
+            << tree->Height() << " | teardown " << teardownSeconds << " seconds" << endl;
+
+        delete tree;
     }
 }
 
 /**
-* Insert a bid
+* Time a full pass of lookups against any tree with a Search method
+*
+* @param tree The tree to search
+* @param keys Ids to look up
+* @param found Receives the number of ids found
+* @return Nanoseconds per lookup
 */
-void BinarySearchTree::Insert(Bid bid) {
-    // if root is nullptr
-    if (root == nullptr) {
-        // root is equal to new node with bid
-        root = new Node(bid);
+template <typename Tree>
+double timeLookups(Tree* tree, const vector<string>& keys, unsigned int& found) {
+    found = 0;
+    clock_t ticks = clock();
+    for (const string& key : keys) {
+        if (tree->Find(key) != nullptr) {
+            ++found;
+        }
     }
-    else {
-        // add Node to the root
-        addNode(root, bid);
+    ticks = clock() - ticks;
+    return ticks * 1.0e9 / CLOCKS_PER_SEC / keys.size();
+}
+
+/**
+* Compare lookup latency of the binary search tree, the B+ tree and
+* a frozen snapshot on the same random bids, for ids present and missing
+*
+* @param count Number of bids to load
+*/
+void benchmarkLookups(unsigned int count) {
+    vector<Bid> bids = makeBids(count, IdOrder::Random);
+
+    // hits probe every id in a different random order, misses fall between ids
+    vector<string> hits, misses;
+    for (const Bid& bid : bids) {
+        hits.push_back(bid.bidId);
+        misses.push_back(bid.bidId + "x");
     }
+    mt19937 rng(301);
+    shuffle(hits.begin(), hits.end(), rng);
+
+    BinarySearchTree* tree = new BinarySearchTree();
+    tree->BulkLoad(bids);
+    BidBTree* btree = new BidBTree();
+    btree->BulkLoad(bids);
+
+    unsigned int found;
+    double nanos = timeLookups(tree, hits, found);
+    cout << "binary search tree: hit " << nanos << " ns (" << found << " found)";
+    nanos = timeLookups(tree, misses, found);
+    cout << " | miss " << nanos << " ns (" << found << " found) | height " << tree->Height() << endl;
+
+    nanos = timeLookups(btree, hits, found);
+    cout << "B+ tree: hit " << nanos << " ns (" << found << " found)";
+    nanos = timeLookups(btree, misses, found);
+    cout << " | miss " << nanos << " ns (" << found << " found) | height " << btree->Height() << endl;
+
+    clock_t ticks = clock();
+    BidSnapshot* snapshot = tree->Freeze();
+    ticks = clock() - ticks;
+
+    nanos = timeLookups(snapshot, hits, found);
+    cout << "snapshot: hit " << nanos << " ns (" << found << " found)";
+    nanos = timeLookups(snapshot, misses, found);
+    cout << " | miss " << nanos << " ns (" << found << " found) | freeze "
+        << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+    delete snapshot;
+    delete tree;
+    delete btree;
 }
 
 /**
-* Remove a bid
+* Compare lookups in trees keyed on id strings and on numeric ids
+*
+* @param count Number of bids to load
 */
-void BinarySearchTree::Remove(string bidId) {
-    // remove node with bidId from root
-    root = removeNode(root, bidId);
+void benchmarkKeyTypes(unsigned int count) {
+    vector<Bid> bids = makeBids(count, IdOrder::Random);
+
+    // misses are numeric ids past the generated ones
+    vector<string> hits, misses;
+    for (unsigned int i = 0; i < count; ++i) {
+        hits.push_back(bids[i].bidId);
+        misses.push_back(to_string(20000000 + i));
+    }
+    mt19937 rng(302);
+    shuffle(hits.begin(), hits.end(), rng);
+
+    BinarySearchTree* stringTree = new BinarySearchTree();
+    stringTree->BulkLoad(bids);
+    NumericBinarySearchTree* numericTree = new NumericBinarySearchTree();
+    numericTree->BulkLoad(bids);
+
+    unsigned int found;
+    double nanos = timeLookups(stringTree, hits, found);
+    cout << "string keys: hit " << nanos << " ns (" << found << " found)";
+    nanos = timeLookups(stringTree, misses, found);
+    cout << " | miss " << nanos << " ns (" << found << " found) | node size "
+        << stringTree->AllocatorStats().nodeBytes << endl;
+
+    nanos = timeLookups(numericTree, hits, found);
+    cout << "numeric keys: hit " << nanos << " ns (" << found << " found)";
+    nanos = timeLookups(numericTree, misses, found);
+    cout << " | miss " << nanos << " ns (" << found << " found) | node size "
+        << numericTree->AllocatorStats().nodeBytes << endl;
+
+    delete stringTree;
+    delete numericTree;
 }
 
 /**
-* Search for a bid
+* Stress a concurrent tree with reader threads while a writer keeps
+* inserting and removing bids, reporting read throughput per thread
+* count
+*
+* Readers only look up ids the writer never touches, so every lookup
+* must succeed; any miss is reported as an error. Times are wall clock
+* since clock() adds up the CPU time of every thread.
+*
+* @param count Number of bids loaded before the readers start
 */
-Bid BinarySearchTree::Search(string bidId) {
-    Node* current = root;
+void benchmarkConcurrentReads(unsigned int count) {
+    const chrono::milliseconds duration(1000);
 
-    while (current != nullptr) {
-        if (current->bid.bidId == bidId) {
-            return current->bid;
+    vector<Bid> bids = makeBids(count, IdOrder::Random);
+    ConcurrentBidTree* tree = new ConcurrentBidTree();
+    for (const Bid& bid : bids) {
+        tree->Insert(bid);
+    }
+
+    unsigned int maxThreads = max(1u, thread::hardware_concurrency());
+    vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    double baseRate = 0.0;
+    for (unsigned int threads : threadCounts) {
+        atomic<bool> stop(false);
+        atomic<unsigned long long> lookups(0), errors(0), writes(0);
+
+        // the writer churns ids outside the loaded range
+        thread writer([&]() {
+            unsigned int next = 0;
+            while (!stop.load()) {
+                Bid bid;
+                bid.bidId = to_string(30000000 + next % 1000);
+                if ((next / 1000) % 2 == 0) {
+                    tree->Insert(bid);
+                }
+                else {
+                    tree->Remove(bid.bidId);
+                }
+                ++next;
+                writes.fetch_add(1);
+            }
+        });
+
+        vector<thread> readers;
+        auto start = chrono::steady_clock::now();
+        for (unsigned int t = 0; t < threads; ++t) {
+            readers.emplace_back([&, t]() {
+                mt19937 rng(400 + t);
+                unsigned long long done = 0, missing = 0;
+                while (!stop.load(memory_order_relaxed)) {
+                    const string& bidId = bids[rng() % bids.size()].bidId;
+                    if (!tree->Visit(bidId, [](const Bid&) {})) {
+                        ++missing;
+                    }
+                    ++done;
+                }
+                lookups.fetch_add(done);
+                errors.fetch_add(missing);
+            });
         }
 
-        if (bidId < current->bid.bidId) {
-            current = current->left;
+        this_thread::sleep_for(duration);
+        stop = true;
+        for (thread& reader : readers) {
+            reader.join();
         }
-        else {
-            current = current->right;
+        writer.join();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        double rate = lookups.load() / seconds;
+        if (baseRate == 0.0) {
+            baseRate = rate;
         }
+        cout << threads << " reader threads: " << rate / 1e6 << " M lookups/s | speedup "
+            << rate / baseRate << "x | " << writes.load() << " writes | "
+            << errors.load() << " errors" << endl;
     }
 
-    Bid bid;
-    return bid;
+    delete tree;
 }
 
 /**
-* Add a bid to some node (recursive)
+* Compare the binary search tree and the radix tree on the same random
+* bids: load time, lookups for ids present and missing, and node bytes
+* per bid
 *
-* @param node Current node in tree
-* @param bid Bid to be added
+* @param count Number of bids to load
 */
-void BinarySearchTree::addNode(Node* node, Bid bid) {
-    // if bid is less than node's bid
-    if (bid.bidId < node->bid.bidId) {
-        // if no left node
-        if (node->left == nullptr) {
-            // this node becomes left
-            node->left = new Node(bid);
-        }
-        else {
-            // else recurse down the left node
-            addNode(node->left, bid);
-        }
+void benchmarkRadixTree(unsigned int count) {
+    vector<Bid> bids = makeBids(count, IdOrder::Random);
+
+    vector<string> hits, misses;
+    for (const Bid& bid : bids) {
+        hits.push_back(bid.bidId);
+        misses.push_back(bid.bidId + "x");
     }
-    else {
-        // if no right node
-        if (node->right == nullptr) {
-            // this node becomes right
-            node->right = new Node(bid);
-        }
-        else {
-            // else recurse down the right node
-            addNode(node->right, bid);
-        }
+    mt19937 rng(303);
+    shuffle(hits.begin(), hits.end(), rng);
+
+    clock_t ticks = clock();
+    BinarySearchTree* tree = new BinarySearchTree();
+    for (const Bid& bid : bids) {
+        tree->Insert(bid);
     }
+    ticks = clock() - ticks;
+    cout << "binary search tree: load " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds";
+
+    unsigned int found;
+    double nanos = timeLookups(tree, hits, found);
+    cout << " | hit " << nanos << " ns (" << found << " found)";
+    nanos = timeLookups(tree, misses, found);
+    NodePoolStats stats = tree->AllocatorStats();
+    cout << " | miss " << nanos << " ns (" << found << " found) | "
+        << stats.liveNodes * stats.nodeBytes / double(count) << " bytes per bid" << endl;
+    delete tree;
+
+    ticks = clock();
+    BidRadixTree* radixTree = new BidRadixTree();
+    for (const Bid& bid : bids) {
+        radixTree->Insert(bid);
+    }
+    ticks = clock() - ticks;
+    cout << "radix tree: load " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds";
+
+    nanos = timeLookups(radixTree, hits, found);
+    cout << " | hit " << nanos << " ns (" << found << " found)";
+    nanos = timeLookups(radixTree, misses, found);
+    cout << " | miss " << nanos << " ns (" << found << " found) | "
+        << radixTree->MemoryUsage() / double(count) << " bytes per bid" << endl;
+    delete radixTree;
 }
 
 /**
-* Remove a bid from some node (recursive)
+* Compare looking up ids one at a time with Find against SearchBatch
+* in the binary search tree
+*
+* @param count Number of bids to load
 */
-Node* BinarySearchTree::removeNode(Node* node, string bidId) {
-    if (node == nullptr) {
-        return node;
+void benchmarkBatchLookups(unsigned int count) {
+    vector<Bid> bids = makeBids(count, IdOrder::Random);
+    BinarySearchTree* tree = new BinarySearchTree();
+    tree->BulkLoad(bids);
+
+    vector<string> ids;
+    for (const Bid& bid : bids) {
+        ids.push_back(bid.bidId);
     }
+    mt19937 rng(306);
+    shuffle(ids.begin(), ids.end(), rng);
+    vector<string_view> keys(ids.begin(), ids.end());
+    vector<const Bid*> found(keys.size());
 
-    if (bidId < node->bid.bidId) {
-        node->left = removeNode(node->left, bidId);
+    clock_t ticks = clock();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        found[i] = tree->Find(keys[i]);
     }
-    else if (bidId > node->bid.bidId) {
-        node->right = removeNode(node->right, bidId);
+    ticks = clock() - ticks;
+    size_t hits = count_if(found.begin(), found.end(), [](const Bid* bid) { return bid != nullptr; });
+    cout << "one at a time: " << ticks * 1.0e9 / CLOCKS_PER_SEC / keys.size() << " ns per id ("
+        << hits << " found)" << endl;
+
+    fill(found.begin(), found.end(), nullptr);
+    ticks = clock();
+    tree->SearchBatch(keys.data(), keys.size(), found.data());
+    ticks = clock() - ticks;
+    hits = count_if(found.begin(), found.end(), [](const Bid* bid) { return bid != nullptr; });
+    cout << "batched: " << ticks * 1.0e9 / CLOCKS_PER_SEC / keys.size() << " ns per id ("
+        << hits << " found)" << endl;
+
+    delete tree;
+}
+
+/**
+* Time lookups of missing and stored ids in the binary search tree
+* without a bloom filter and with filters of several sizes
+*
+* @param count Number of bids to load
+*/
+void benchmarkBloomFilter(unsigned int count) {
+    const double bitsPerKey[] = { 0, 4, 8, 12, 16 };
+
+    vector<Bid> bids = makeBids(count, IdOrder::Random);
+    vector<string> hits, misses;
+    for (const Bid& bid : bids) {
+        hits.push_back(bid.bidId);
+        misses.push_back(bid.bidId + "x");
     }
-    else {
-        if (node->left == nullptr) {
-            Node* temp = node->right;
-            delete node;
-            return temp;
+    mt19937 rng(308);
+    shuffle(hits.begin(), hits.end(), rng);
+    shuffle(misses.begin(), misses.end(), rng);
+
+    BinarySearchTree* tree = new BinarySearchTree();
+    tree->BulkLoad(bids);
+
+    for (double bits : bitsPerKey) {
+        if (bits == 0) {
+            tree->DisableFilter();
+            cout << "no filter:" << endl;
         }
-        else if (node->right == nullptr) {
-            Node* temp = node->left;
-            delete node;
-            return temp;
+        else {
+            tree->EnableFilter(bits);
+            cout << bits << " bits per id:" << endl;
         }
 
-        Node* temp = node->right;
-        while (temp && temp->left != nullptr) {
-            temp = temp->left;
+        unsigned int found;
+        double nanos = timeLookups(tree, misses, found);
+        cout << "  miss " << nanos << " ns (" << found << " found)";
+        nanos = timeLookups(tree, hits, found);
+        cout << " | hit " << nanos << " ns (" << found << " found)" << endl;
+        if (bits != 0) {
+            displayFilterStats(tree->FilterStats());
         }
-        node->bid = temp->bid;
-        node->right = removeNode(node->right, temp->bid.bidId);
     }
-    return node;
-}
-
-//============================================================================
-// Static methods used for testing
-//============================================================================
 
-/**
-* Display the bid information to the console (std::out)
-*
-* @param bid struct containing the bid info
-*/
-void displayBid(Bid bid) {
-    cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
-        << bid.fund << endl;
+    delete tree;
 }
 
 /**
-* Load a CSV file containing bids into a container
+* Time a cold start from a snapshot file against bulk loading the tree,
+* and lookups in the mapped file against the tree
 *
-* @param csvPath the path to the CSV file to load
-* @return a container holding all the bids read
+* @param count Number of bids to load
 */
-void loadBids(string csvPath, BinarySearchTree* bst) {
-    cout << "Loading CSV file " << csvPath << endl;
+void benchmarkSnapshot(unsigned int count) {
+    const string path = "benchmark.snap";
 
-    // initialize the CSV Parser using the given path
-    csv::Parser file = csv::Parser(csvPath);
-
-    // read and display header row - optional
-    vector<string> header = file.getHeader();
-    for (auto const& c : header) {
-        cout << c << " | ";
+    vector<Bid> bids = makeBids(count, IdOrder::Random);
+    vector<string> ids;
+    for (const Bid& bid : bids) {
+        ids.push_back(bid.bidId);
     }
-    cout << "" << endl;
+    mt19937 rng(309);
+    shuffle(ids.begin(), ids.end(), rng);
 
-    try {
-        // loop to read rows of a CSV file
-        for (unsigned int i = 0; i < file.rowCount(); i++) {
+    BinarySearchTree* tree = new BinarySearchTree();
+    clock_t ticks = clock();
+    tree->BulkLoad(bids);
+    ticks = clock() - ticks;
+    cout << "bulk load " << count << " bids: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
 
-            // Create a data structure and add to the collection of bids
-            Bid bid;
-            bid.bidId = file[i][1];
-            bid.title = file[i][0];
-            bid.fund = file[i][8];
-            bid.amount = strToDouble(file[i][4], '$');
+    ticks = clock();
+    saveSnapshot(tree, path);
+    ticks = clock() - ticks;
+    cout << "write snapshot: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
 
-            // push this bid to the end
-            bst->Insert(bid);
-        }
+    MappedBids snapshot;
+    for (bool verify : { true, false }) {
+        ticks = clock();
+        snapshot.Open(path, verify);
+        ticks = clock() - ticks;
+        cout << "open snapshot" << (verify ? " and verify checksum" : "") << ": "
+            << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
     }
-    catch (csv::Error& e) {
-        std::cerr << e.what() << std::endl;
+
+    unsigned int found;
+    double nanos = timeLookups(tree, ids, found);
+    cout << "tree lookup " << nanos << " ns (" << found << " found)";
+    found = 0;
+    ticks = clock();
+    MappedBids::BidView bid;
+    for (const string& id : ids) {
+        if (snapshot.Find(id, bid)) {
+            ++found;
+        }
     }
+    ticks = clock() - ticks;
+    cout << " | snapshot lookup " << ticks * 1.0e9 / CLOCKS_PER_SEC / ids.size() << " ns ("
+        << found << " found)" << endl;
+
+    snapshot.Close();
+    remove(path.c_str());
+    delete tree;
 }
 
 /**
-* Simple C function to convert a string to a double
-* after stripping out unwanted char
-*
-* credit: http://stackoverflow.com/a/24875936
-*
-* @param ch The character to strip out
+* Benchmark menu
 */
-double strToDouble(string str, char ch) {
-    str.erase(remove(str.begin(), str.end(), ch), str.end());
-    return atof(str.c_str());
+void runBenchmarks() {
+    cout << "Benchmarks:" << endl;
+    cout << "  1. Load Orders" << endl;
+    cout << "  2. Tree Lookups" << endl;
+    cout << "  3. Key Types" << endl;
+    cout << "  4. Concurrent Reads" << endl;
+    cout << "  5. Radix Tree" << endl;
+    cout << "  6. Batch Lookups" << endl;
+    cout << "  7. Bloom Filter" << endl;
+    cout << "  8. Snapshot File" << endl;
+    cout << "Enter choice: ";
+
+    int choice = 0;
+    cin >> choice;
+
+    switch (choice) {
+    case 1:
+        benchmarkLoadOrders(BENCHMARK_SIZE);
+        break;
+
+    case 2:
+        benchmarkLookups(BENCHMARK_SIZE);
+        break;
+
+    case 3:
+        benchmarkKeyTypes(BENCHMARK_SIZE);
+        break;
+
+    case 4:
+        benchmarkConcurrentReads(BENCHMARK_SIZE);
+        break;
+
+    case 5:
+        benchmarkRadixTree(BENCHMARK_SIZE);
+        break;
+
+    case 6:
+        benchmarkBatchLookups(BENCHMARK_SIZE);
+        break;
+
+    case 7:
+        benchmarkBloomFilter(BENCHMARK_SIZE);
+        break;
+
+    case 8:
+        benchmarkSnapshot(BENCHMARK_SIZE);
+        break;
+    }
 }
 
 /**
@@ -316,17 +3674,43 @@ int main(int argc, char* argv[]) {
     clock_t ticks;
 
     // Define a binary search tree to hold all bids
-    BinarySearchTree* bst;
-    bst = new BinarySearchTree();
-    Bid bid;
+    // Bid ids are numeric, so key the tree on their integer values
+    NumericBinarySearchTree* bst;
+    bst = new NumericBinarySearchTree();
+    const Bid* bid;
+
+    // Read-only copy of the tree used by Find Bid once frozen
+    BidSnapshot* snapshot = nullptr;
+
+    // pick up where the last run left off, then log every change so
+    // the next run can too
+    string snapshotPath = csvPath + ".snap";
+    string logPath = csvPath + ".log";
+    BidLog* changeLog = nullptr;
+    try {
+        uint64_t sequence = recoverBids(bst, snapshotPath, logPath);
+        changeLog = new BidLog(logPath, sequence);
+        if (changeLog->GetStats().bytes > 0) {
+            checkpoint(bst, changeLog, snapshotPath);
+        }
+        bst->AttachLog(changeLog);
+    }
+    catch (runtime_error& e) {
+        cerr << e.what() << endl;
+        cerr << "changes will not be saved" << endl;
+    }
 
     int choice = 0;
     while (choice != 9) {
         cout << "Menu:" << endl;
-        cout << "  1. Load Bids" << endl;
+        cout << "  1. Load Bids (replaces recovered bids)" << endl;
         cout << "  2. Display All Bids" << endl;
         cout << "  3. Find Bid" << endl;
         cout << "  4. Remove Bid" << endl;
+        cout << "  5. Run Benchmarks" << endl;
+        cout << "  6. Show Allocator Stats" << endl;
+        cout << "  7. Range Report" << endl;
+        cout << "  8. Freeze Tree For Lookups" << endl;
         cout << "  9. Exit" << endl;
         cout << "Enter choice: ";
         cin >> choice;
@@ -334,11 +3718,29 @@ int main(int argc, char* argv[]) {
         switch (choice) {
 
         case 1:
+            // a snapshot would miss the new bids
+            delete snapshot;
+            snapshot = nullptr;
+
             // Initialize a timer variable before loading bids
             ticks = clock();
 
-            // Complete the method call to load the bids
+            // Complete the method call to load the bids, a checkpoint
+            // saves them instead of logging every row. The CSV file
+            // replaces the recovered bids rather than adding to them,
+            // which would duplicate them and bring back removed ones
+            delete bst;
+            bst = new NumericBinarySearchTree();
             loadBids(csvPath, bst);
+            bst->AttachLog(changeLog);
+            if (changeLog != nullptr) {
+                try {
+                    checkpoint(bst, changeLog, snapshotPath);
+                }
+                catch (runtime_error& e) {
+                    cerr << e.what() << endl;
+                }
+            }
 
             // Calculate elapsed time and display result
             ticks = clock() - ticks; // current clock ticks minus starting clock ticks
@@ -354,13 +3756,13 @@ int main(int argc, char* argv[]) {
             // Initialize a timer variable before searching for a bid
             ticks = clock();
 
-            bid = bst->Search(bidKey);
+            bid = snapshot != nullptr ? snapshot->Find(bidKey) : bst->Find(bidKey);
 
             // Calculate elapsed time and display result
             ticks = clock() - ticks; // current clock ticks minus starting clock ticks
 
-            if (!bid.bidId.empty()) {
-                displayBid(bid);
+            if (bid != nullptr) {
+                displayBid(*bid);
             }
             else {
                 cout << "Bid Id " << bidKey << " not found." << endl;
@@ -372,13 +3774,61 @@ int main(int argc, char* argv[]) {
             break;
 
         case 4:
+            // a snapshot would still return the removed bid
+            delete snapshot;
+            snapshot = nullptr;
+
             bst->Remove(bidKey);
             break;
+
+        case 5:
+            runBenchmarks();
+            break;
+
+        case 6:
+            displayPoolStats(bst->AllocatorStats());
+            break;
+
+        case 7:
+            rangeReport(bst);
+            break;
+
+        case 8:
+            delete snapshot;
+            snapshot = bst->Freeze();
+            cout << snapshot->Size() << " bids frozen" << endl;
+            break;
+        }
+
+        // report changes the log could not save, and replace a long
+        // change log with a snapshot now and then
+        if (changeLog != nullptr) {
+            try {
+                changeLog->Check();
+                if (changeLog->NeedsCheckpoint()) {
+                    checkpoint(bst, changeLog, snapshotPath);
+                }
+            }
+            catch (runtime_error& e) {
+                cerr << e.what() << endl;
+            }
         }
     }
 
     cout << "Good bye." << endl;
 
+    // sync the last changes, the destructor cannot report a failure
+    if (changeLog != nullptr) {
+        try {
+            changeLog->Sync();
+        }
+        catch (runtime_error& e) {
+            cerr << e.what() << endl;
+            cerr << "the last changes were not saved" << endl;
+        }
+    }
+    delete changeLog;
+
     return 0;
 }
 
@@ -7,12 +7,35 @@
 //============================================================================
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <climits>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
 #include <string>
+#include <string_view>
+#include <thread>
 #include <time.h>
 #include <vector>
+#include "BidHash.hpp"
+#include "BidKey.hpp"
+#include "BidLog.hpp"
+#include "BloomFilter.hpp"
 #include "CSVparser.hpp"
+#include "MappedBids.hpp"
+#include "NodePool.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <xmmintrin.h>
+#endif
 
 using namespace std;
 
@@ -22,9 +45,32 @@ using namespace std;
 
 const unsigned int DEFAULT_SIZE = 179;
 
+// number of synthetic ids used by the benchmarks
+const unsigned int BENCHMARK_SIZE = 1000000;
+
+// lookups a batch search keeps in flight at once
+const size_t BATCH_LANES = 16;
+
+// fewest ids a rebuilt bloom filter is sized for
+const size_t FILTER_MIN_KEYS = 1024;
+
+// removes timed by the change log benchmark, each may wait for an fsync
+const unsigned int LOG_REMOVES = 2000;
+
 // forward declarations
 double strToDouble(string str, char ch);
 
+/**
+ * Hint the processor to start loading a cache line we will need soon
+ */
+inline void prefetch(const void* address) {
+#if defined(_MSC_VER)
+    _mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+    __builtin_prefetch(address);
+#endif
+}
+
 // define a structure to hold bid information
 struct Bid {
     string bidId; // unique identifier
@@ -40,248 +86,1695 @@ struct Bid {
 // Hash Table class definition
 //============================================================================
 
+// slots whose control bytes are matched together, one SSE2 register
+const unsigned int GROUP_WIDTH = 16;
+
+// control byte values, full slots hold the low 7 bits of their hash
+const int8_t CTRL_EMPTY = -128;
+const int8_t CTRL_DELETED = -2;
+
+// slots of an outgrown table moved to its replacement per Insert or Remove
+const size_t MIGRATE_STEP = 16;
+
+/**
+ * Index of the lowest set bit of a nonzero mask
+ */
+inline int lowestBit(unsigned int mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return int(index);
+#else
+    return __builtin_ctz(mask);
+#endif
+}
+
+/**
+ * Bit i is set when control byte i of a group equals value
+ */
+inline unsigned int matchByte(const int8_t* group, int8_t value) {
+#if defined(__SSE2__) || defined(_M_X64)
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(value)));
+#else
+    unsigned int mask = 0;
+    for (unsigned int i = 0; i < GROUP_WIDTH; ++i) {
+        if (group[i] == value) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+/**
+ * Bit i is set when slot i of a group is empty or deleted, which are
+ * the only control bytes with the sign bit set
+ */
+inline unsigned int matchFree(const int8_t* group) {
+#if defined(__SSE2__) || defined(_M_X64)
+    return _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(group)));
+#else
+    unsigned int mask = 0;
+    for (unsigned int i = 0; i < GROUP_WIDTH; ++i) {
+        if (group[i] < 0) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+#endif
+}
+
+// groups probed by each kind of operation since the table was created
+struct ProbeCounters {
+    unsigned long long searches = 0;
+    unsigned long long searchProbes = 0;
+    unsigned long long inserts = 0;
+    unsigned long long insertProbes = 0;
+    unsigned long long removes = 0;
+    unsigned long long removeProbes = 0;
+};
+
+// ProbeCounters as a table keeps them, relaxed atomics so lookups that
+// share a lock can count side by side
+struct AtomicProbeCounters {
+    atomic<unsigned long long> searches{ 0 };
+    atomic<unsigned long long> searchProbes{ 0 };
+    atomic<unsigned long long> inserts{ 0 };
+    atomic<unsigned long long> insertProbes{ 0 };
+    atomic<unsigned long long> removes{ 0 };
+    atomic<unsigned long long> removeProbes{ 0 };
+
+    // count one operation and the groups it probed
+    static void Add(atomic<unsigned long long>& operations, atomic<unsigned long long>& groups,
+        unsigned long long probes) {
+        operations.fetch_add(1, memory_order_relaxed);
+        groups.fetch_add(probes, memory_order_relaxed);
+    }
+
+    ProbeCounters Load() const {
+        ProbeCounters counters;
+        counters.searches = searches.load(memory_order_relaxed);
+        counters.searchProbes = searchProbes.load(memory_order_relaxed);
+        counters.inserts = inserts.load(memory_order_relaxed);
+        counters.insertProbes = insertProbes.load(memory_order_relaxed);
+        counters.removes = removes.load(memory_order_relaxed);
+        counters.removeProbes = removeProbes.load(memory_order_relaxed);
+        return counters;
+    }
+};
+
+// hash table statistics, the probe lengths are measured when requested
+struct HashTableStats {
+    size_t size = 0;                // bids stored
+    size_t capacity = 0;            // slots in both tables
+    size_t bytes = 0;               // control bytes, slots and bid nodes
+    double loadFactor = 0.0;        // full and deleted slots per slot
+    size_t longestProbe = 0;        // most groups probed to reach a stored bid
+    vector<size_t> probeHistogram;  // bids by number of groups probed to reach them
+    ProbeCounters counters;
+};
+
 /**
  * Define a class containing data members and methods to
- * implement a hash table with chaining.
+ * implement a hash table with open addressing.
+ *
+ * Bids live in nodes from a NodePool. The table itself is one flat
+ * array of slots, each only the full hash of a bid and a pointer to
+ * its node, so empty and deleted slots cost 16 bytes rather than a
+ * whole bid. A parallel array holds one control byte per slot: empty,
+ * deleted, or 7 bits of the hash of the bid stored there. A lookup
+ * compares 16 control bytes at a time and only looks at slots whose
+ * byte matches, then checks the full stored hash before following
+ * the pointer to compare ids. Groups are probed in a triangular
+ * sequence, which visits every group of a power-of-two table.
+ *
+ * When the table fills up, a larger one takes over inserts and the
+ * old one drains into it a few slots per Insert and Remove, so no
+ * single call pays for moving every bid. Lookups check both tables
+ * until the old one is empty.
+ *
+ * An optional bloom filter answers most lookups of missing ids
+ * without probing the table. An attached change log records every
+ * insert and remove, see BidLog.
+ *
+ * Key picks how ids are compared and hashed, see BidKeyTraits.
+ * Hasher is the hash policy, see BidHash.hpp. Seeding it differently
+ * per table keeps crafted ids from piling into one probe sequence.
+ */
+template <typename Key, typename Hasher = WyHash>
+class BasicHashTable {
+
+private:
+    typedef BidKeyTraits<Key> Traits;
+    typedef typename Traits::Probe Probe;
+
+    // Define structures to hold bids, the base caches the bid's key
+    struct Node : Traits::Cached {
+        Bid bid;
+
+        // initialize with a bid, taking over its strings
+        Node(Bid aBid) {
+            bid = move(aBid);
+            this->Cache(bid.bidId);
+        }
+    };
+
+    // a full slot points at the node of its bid
+    struct Slot {
+        unsigned int key = UINT_MAX; // full hash of the bid id
+        Node* node = nullptr;
+    };
+
+    // one open-addressed array of slots
+    struct Table {
+        // control bytes, the first group is repeated past the end so a
+        // group starting at any slot can be loaded without wrapping
+        vector<int8_t> control;
+        vector<Slot> slots;
+        size_t mask = 0;  // slot count minus one
+        size_t count = 0; // full slots
+        size_t used = 0;  // full and deleted slots
+
+        void allocate(size_t capacity);
+        void setControl(size_t slot, int8_t value);
+        size_t findFree(unsigned int key, unsigned long long& probes) const;
+        size_t findSlot(const Probe& probe, unsigned int key, unsigned long long& probes) const;
+        void place(Slot slot, unsigned long long& probes);
+        void erase(size_t slot);
+        bool full() const;
+        size_t probeLength(size_t slot) const;
+    };
+
+    Hasher hasher;
+    NodePool<Node> pool;
+    Table table;      // receives every insert
+    Table draining;   // previous table while its bids move over
+    size_t drainNext; // next slot of the draining table to move
+    mutable AtomicProbeCounters counters;
+    BloomFilter* filter;
+    BidLog* log; // not owned
+
+    unsigned int hash(const Probe& key) const;
+    const Bid* find(const Probe& probe, unsigned int key) const;
+    void migrate(size_t slotCount);
+    void startDrain(size_t capacity);
+    void rebuildFilter();
+
+public:
+    BasicHashTable();
+    BasicHashTable(unsigned int size, Hasher aHasher = Hasher());
+    virtual ~BasicHashTable();
+    void Insert(const Bid& bid);
+    void Insert(Bid&& bid);
+    void Reserve(size_t bidCount);
+    void PrintAll();
+    template <typename Visitor>
+    void ForEach(Visitor visit) const;
+    void Remove(string_view bidId);
+    const Bid* Find(string_view bidId) const;
+    Bid Search(string_view bidId) const;
+    void SearchBatch(const string_view* bidIds, size_t count, const Bid** found) const;
+    size_t Size();
+    HashTableStats Stats();
+    NodePoolStats AllocatorStats();
+    void EnableFilter(double bitsPerKey);
+    void DisableFilter();
+    BloomFilterStats FilterStats();
+    void AttachLog(BidLog* aLog);
+};
+
+// Table keyed on id strings
+typedef BasicHashTable<string> HashTable;
+
+// Table keyed on id strings with the original multiply-by-31 hash
+typedef BasicHashTable<string, MultiplyHash> MultiplyHashTable;
+
+// Table keyed on numeric ids, falling back to strings for other ids
+typedef BasicHashTable<uint64_t> NumericHashTable;
+
+/**
+ * Default constructor
+ */
+template <typename Key, typename Hasher>
+BasicHashTable<Key, Hasher>::BasicHashTable() : BasicHashTable(DEFAULT_SIZE) {
+}
+
+/**
+ * Constructor for specifying size of the table
+ * Use to improve efficiency of hashing algorithm
+ * by reducing collisions without wasting memory.
+ * The slot count is rounded up to a power of two, so a slot is
+ * picked by masking hash bits rather than taking a remainder.
+ */
+template <typename Key, typename Hasher>
+BasicHashTable<Key, Hasher>::BasicHashTable(unsigned int size, Hasher aHasher) : hasher(aHasher) {
+    size_t capacity = GROUP_WIDTH;
+    while (capacity < size) {
+        capacity *= 2;
+    }
+    table.allocate(capacity);
+    drainNext = 0;
+    filter = nullptr;
+    log = nullptr;
+}
+
+/**
+ * Destructor
+ */
+template <typename Key, typename Hasher>
+BasicHashTable<Key, Hasher>::~BasicHashTable() {
+    // the pool frees its blocks but leaves destroying nodes to us
+    for (const Table* current : { &table, &draining }) {
+        for (size_t i = 0; i < current->slots.size(); ++i) {
+            if (current->control[i] >= 0) {
+                pool.Destroy(current->slots[i].node);
+            }
+        }
+    }
+    delete filter;
+}
+
+/**
+ * Calculate the hash value of a given key.
+ *
+ * @param key The key to hash
+ * @return The calculated hash, its low 7 bits go in the control byte
+ *         and the rest pick the first group to probe
+ */
+template <typename Key, typename Hasher>
+unsigned int BasicHashTable<Key, Hasher>::hash(const Probe& key) const {
+    return Traits::Hash(key, hasher);
+}
+
+/**
+ * Replace the slots with an empty table
+ *
+ * @param capacity Slot count, a power of two of at least one group
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::Table::allocate(size_t capacity) {
+    control.assign(capacity + GROUP_WIDTH, CTRL_EMPTY);
+    slots.clear();
+    slots.resize(capacity);
+    mask = capacity - 1;
+    count = 0;
+    used = 0;
+}
+
+/**
+ * Set the control byte of a slot and its copy past the end
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::Table::setControl(size_t slot, int8_t value) {
+    control[slot] = value;
+    if (slot < GROUP_WIDTH) {
+        control[mask + 1 + slot] = value;
+    }
+}
+
+/**
+ * First empty or deleted slot on the probe sequence of a hash
+ *
+ * @param probes Incremented for every group probed
+ */
+template <typename Key, typename Hasher>
+size_t BasicHashTable<Key, Hasher>::Table::findFree(unsigned int key, unsigned long long& probes) const {
+    size_t position = (key >> 7) & mask;
+    for (size_t step = GROUP_WIDTH;; step += GROUP_WIDTH) {
+        ++probes;
+        unsigned int free = matchFree(&control[position]);
+        if (free != 0) {
+            return (position + lowestBit(free)) & mask;
+        }
+        position = (position + step) & mask;
+    }
+}
+
+/**
+ * Slot holding a bid id
+ *
+ * @param probe The id being looked up
+ * @param key Hash of the id
+ * @param probes Incremented for every group probed
+ * @return The slot, or SIZE_MAX when the id is not in the table
+ */
+template <typename Key, typename Hasher>
+size_t BasicHashTable<Key, Hasher>::Table::findSlot(const Probe& probe, unsigned int key, unsigned long long& probes) const {
+    if (slots.empty()) {
+        return SIZE_MAX;
+    }
+
+    int8_t tag = int8_t(key & 0x7F);
+    size_t position = (key >> 7) & mask;
+    for (size_t step = GROUP_WIDTH;; step += GROUP_WIDTH) {
+        ++probes;
+        const int8_t* group = &control[position];
+        for (unsigned int matches = matchByte(group, tag); matches != 0; matches &= matches - 1) {
+            size_t slot = (position + lowestBit(matches)) & mask;
+            if (slots[slot].key == key && Traits::Equal(Traits::ProbeOf(*slots[slot].node), probe)) {
+                return slot;
+            }
+        }
+        // an empty slot ends every probe sequence that passes through it
+        if (matchByte(group, CTRL_EMPTY) != 0) {
+            return SIZE_MAX;
+        }
+        position = (position + step) & mask;
+    }
+}
+
+/**
+ * Store a slot in the first free slot on its probe sequence, the
+ * caller makes sure the table has room
+ *
+ * @param probes Incremented for every group probed
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::Table::place(Slot slot, unsigned long long& probes) {
+    size_t position = findFree(slot.key, probes);
+    if (control[position] == CTRL_EMPTY) {
+        ++used;
+    }
+    setControl(position, int8_t(slot.key & 0x7F));
+    slots[position] = slot;
+    ++count;
+}
+
+/**
+ * Empty a full slot, its node is left to the caller
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::Table::erase(size_t slot) {
+    // the slot stays deleted rather than empty so probe sequences
+    // running through it still reach the bids past it
+    setControl(slot, CTRL_DELETED);
+    slots[slot] = Slot();
+    --count;
+}
+
+/**
+ * True when one more bid would leave less than one slot in eight
+ * empty, past which probe sequences get long
+ */
+template <typename Key, typename Hasher>
+bool BasicHashTable<Key, Hasher>::Table::full() const {
+    size_t capacity = mask + 1;
+    return used + 1 > capacity - capacity / 8;
+}
+
+/**
+ * Number of groups a lookup probes to reach a full slot
+ */
+template <typename Key, typename Hasher>
+size_t BasicHashTable<Key, Hasher>::Table::probeLength(size_t slot) const {
+    size_t position = (slots[slot].key >> 7) & mask;
+    size_t groups = 1;
+    for (size_t step = GROUP_WIDTH; ((slot - position) & mask) >= GROUP_WIDTH; step += GROUP_WIDTH) {
+        position = (position + step) & mask;
+        ++groups;
+    }
+    return groups;
+}
+
+/**
+ * Move bids from the draining table into the current one, only their
+ * slots move and the nodes stay where they are
+ *
+ * @param slotCount Number of draining slots to visit
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::migrate(size_t slotCount) {
+    if (draining.slots.empty()) {
+        return;
+    }
+
+    // moving bids is not counted against any operation
+    unsigned long long probes = 0;
+    size_t end = min(draining.slots.size(), drainNext + min(slotCount, draining.slots.size()));
+    for (; drainNext < end; ++drainNext) {
+        if (draining.control[drainNext] >= 0) {
+            table.place(draining.slots[drainNext], probes);
+            draining.erase(drainNext);
+        }
+    }
+
+    if (drainNext == draining.slots.size()) {
+        draining = Table();
+    }
+}
+
+/**
+ * Start inserting into a fresh table, the current one becomes the
+ * draining table
+ *
+ * @param capacity Slot count of the new table, a power of two
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::startDrain(size_t capacity) {
+    // a drain visits MIGRATE_STEP slots per change and the new table
+    // is at most 7/16 full, so it finishes long before the new table
+    // fills; finishing it here only matters for tiny tables
+    migrate(SIZE_MAX);
+
+    draining = move(table);
+    table = Table();
+    table.allocate(capacity);
+    drainNext = 0;
+}
+
+/**
+ * Insert a copy of a bid
+ *
+ * @param bid The bid to insert
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::Insert(const Bid& bid) {
+    Insert(Bid(bid));
+}
+
+/**
+ * Insert a bid, moving its strings into the table
+ *
+ * @param bid The bid to insert
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::Insert(Bid&& bid) {
+    // Implement logic to insert a bid, logged first so a change the
+    // log cannot save throws before it is made
+    if (log != nullptr) {
+        log->Insert(bid);
+    }
+
+    migrate(MIGRATE_STEP);
+    if (table.full()) {
+        // when deleted slots are most of the load, a table of the
+        // same size is enough to clear them out
+        size_t capacity = table.mask + 1;
+        startDrain(table.count + 1 > capacity * 7 / 16 ? capacity * 2 : capacity);
+    }
+
+    // the node is made once the table has room, nothing past here throws
+    Slot slot;
+    slot.node = pool.Create(move(bid));
+    slot.key = hash(Traits::ProbeOf(*slot.node));
+    if (filter != nullptr) {
+        filter->Add(slot.node->bid.bidId);
+    }
+    unsigned long long probes = 0;
+    table.place(slot, probes);
+    AtomicProbeCounters::Add(counters.inserts, counters.insertProbes, probes);
+
+    if (filter != nullptr && filter->Stale()) {
+        rebuildFilter();
+    }
+}
+
+/**
+ * Make room for a number of bids up front, so loading them never
+ * grows the table
+ *
+ * @param bidCount Total number of bids the table should hold
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::Reserve(size_t bidCount) {
+    size_t capacity = table.mask + 1;
+    while (capacity - capacity / 8 < bidCount + 1) {
+        capacity *= 2;
+    }
+
+    if (capacity > table.mask + 1) {
+        // an explicit request, so move everything right away
+        startDrain(capacity);
+        migrate(SIZE_MAX);
+    }
+}
+
+/**
+ * Print all bids
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::PrintAll() {
+    // Implement logic to print all bids
+    for (const Table* current : { &draining, &table }) {
+        for (size_t i = 0; i < current->slots.size(); ++i) {
+            if (current->control[i] >= 0) {
+                const Bid& bid = current->slots[i].node->bid;
+                cout << "Key " << i << ": " << bid.bidId << " | " << bid.title << " | " << bid.amount << " | " << bid.fund << endl;
+            }
+        }
+    }
+}
+
+/**
+ * Call a visitor with every bid, in no particular order
+ *
+ * @param visit Called with each bid
+ */
+template <typename Key, typename Hasher>
+template <typename Visitor>
+void BasicHashTable<Key, Hasher>::ForEach(Visitor visit) const {
+    for (const Table* current : { &draining, &table }) {
+        for (size_t i = 0; i < current->slots.size(); ++i) {
+            if (current->control[i] >= 0) {
+                visit(current->slots[i].node->bid);
+            }
+        }
+    }
+}
+
+/**
+ * Remove a bid
+ *
+ * @param bidId The bid id to search for
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::Remove(string_view bidId) {
+    // Implement logic to remove a bid
+    Probe probe = Traits::MakeProbe(bidId);
+    unsigned int key = hash(probe);
+
+    unsigned long long probes = 0;
+    Table* owner = &table;
+    size_t slot = table.findSlot(probe, key, probes);
+    if (slot == SIZE_MAX) {
+        owner = &draining;
+        slot = draining.findSlot(probe, key, probes);
+    }
+    AtomicProbeCounters::Add(counters.removes, counters.removeProbes, probes);
+
+    if (slot != SIZE_MAX) {
+        // logged first, a change the log cannot save throws before it is made
+        if (log != nullptr) {
+            log->Remove(bidId);
+        }
+        pool.Destroy(owner->slots[slot].node);
+        owner->erase(slot);
+
+        if (filter != nullptr) {
+            filter->NoteRemove();
+            if (filter->Stale()) {
+                rebuildFilter();
+            }
+        }
+    }
+
+    migrate(MIGRATE_STEP);
+}
+
+/**
+ * Find the specified bidId without copying the bid
+ *
+ * @param bidId The bid id to search for
+ * @return The stored bid, or nullptr when not found. It stays valid
+ *         until the table is next changed.
+ */
+template <typename Key, typename Hasher>
+const Bid* BasicHashTable<Key, Hasher>::Find(string_view bidId) const {
+    if (filter != nullptr && !filter->MightContain(bidId)) {
+        return nullptr;
+    }
+
+    Probe probe = Traits::MakeProbe(bidId);
+    const Bid* found = find(probe, hash(probe));
+    if (found == nullptr && filter != nullptr) {
+        filter->NoteFalsePositive();
+    }
+    return found;
+}
+
+/**
+ * Find an id whose hash is already known, in both tables
+ */
+template <typename Key, typename Hasher>
+const Bid* BasicHashTable<Key, Hasher>::find(const Probe& probe, unsigned int key) const {
+    unsigned long long probes = 0;
+    const Bid* found = nullptr;
+    size_t slot = table.findSlot(probe, key, probes);
+    if (slot != SIZE_MAX) {
+        found = &table.slots[slot].node->bid;
+    }
+    else {
+        slot = draining.findSlot(probe, key, probes);
+        found = slot != SIZE_MAX ? &draining.slots[slot].node->bid : nullptr;
+    }
+    AtomicProbeCounters::Add(counters.searches, counters.searchProbes, probes);
+    return found;
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ * @return A copy of the bid, or an empty bid when not found
+ */
+template <typename Key, typename Hasher>
+Bid BasicHashTable<Key, Hasher>::Search(string_view bidId) const {
+    const Bid* found = Find(bidId);
+    return found != nullptr ? *found : Bid();
+}
+
+/**
+ * Find many bids at once, overlapping their cache misses
+ *
+ * Ids are taken BATCH_LANES at a time. All of them are hashed and the
+ * first group and slot each one probes are prefetched before any is
+ * looked up, so the loads for later ids are under way while earlier
+ * ids are compared.
+ *
+ * @param bidIds Ids to look up
+ * @param count Number of ids
+ * @param found Receives the stored bid for each id, or nullptr, valid
+ *        as for Find
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::SearchBatch(const string_view* bidIds, size_t count, const Bid** found) const {
+    Probe probes[BATCH_LANES];
+    unsigned int keys[BATCH_LANES];
+    bool ruledOut[BATCH_LANES];
+
+    for (size_t first = 0; first < count; first += BATCH_LANES) {
+        size_t lanes = min(BATCH_LANES, count - first);
+
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            ruledOut[lane] = filter != nullptr && !filter->MightContain(bidIds[first + lane]);
+            if (ruledOut[lane]) {
+                continue;
+            }
+            probes[lane] = Traits::MakeProbe(bidIds[first + lane]);
+            keys[lane] = hash(probes[lane]);
+            size_t position = (keys[lane] >> 7) & table.mask;
+            prefetch(&table.control[position]);
+            prefetch(&table.slots[position]);
+        }
+
+        for (size_t lane = 0; lane < lanes; ++lane) {
+            if (ruledOut[lane]) {
+                found[first + lane] = nullptr;
+                continue;
+            }
+            found[first + lane] = find(probes[lane], keys[lane]);
+            if (found[first + lane] == nullptr && filter != nullptr) {
+                filter->NoteFalsePositive();
+            }
+        }
+    }
+}
+
+/**
+ * Number of bids in the table
+ */
+template <typename Key, typename Hasher>
+size_t BasicHashTable<Key, Hasher>::Size() {
+    return table.count + draining.count;
+}
+
+/**
+ * Table statistics
+ *
+ * The operation counters are kept all the time at the cost of an
+ * increment per probed group; the probe lengths of stored bids are
+ * measured here by walking every slot. Bytes count the control and
+ * slot arrays and the node pool, not id and title text too long to
+ * fit inside a string.
+ */
+template <typename Key, typename Hasher>
+HashTableStats BasicHashTable<Key, Hasher>::Stats() {
+    HashTableStats stats;
+    stats.size = Size();
+    stats.counters = counters.Load();
+
+    size_t used = 0;
+    stats.bytes = pool.GetStats().bytes;
+    for (const Table* current : { &table, &draining }) {
+        stats.capacity += current->slots.size();
+        stats.bytes += current->control.size() + current->slots.size() * sizeof(Slot);
+        used += current->used;
+        for (size_t i = 0; i < current->slots.size(); ++i) {
+            if (current->control[i] >= 0) {
+                size_t groups = current->probeLength(i);
+                if (groups >= stats.probeHistogram.size()) {
+                    stats.probeHistogram.resize(groups + 1, 0);
+                }
+                ++stats.probeHistogram[groups];
+                stats.longestProbe = max(stats.longestProbe, groups);
+            }
+        }
+    }
+    stats.loadFactor = stats.capacity > 0 ? double(used) / stats.capacity : 0.0;
+    return stats;
+}
+
+/**
+ * Node pool statistics
+ */
+template <typename Key, typename Hasher>
+NodePoolStats BasicHashTable<Key, Hasher>::AllocatorStats() {
+    return pool.GetStats();
+}
+
+/**
+ * Put a bloom filter in front of lookups, replacing any earlier one
+ *
+ * @param bitsPerKey Filter bits per bid, see BloomFilter
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::EnableFilter(double bitsPerKey) {
+    delete filter;
+    filter = new BloomFilter(FILTER_MIN_KEYS, bitsPerKey);
+    rebuildFilter();
+}
+
+/**
+ * Drop the bloom filter, every lookup probes the table again
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::DisableFilter() {
+    delete filter;
+    filter = nullptr;
+}
+
+/**
+ * Bloom filter statistics, all zero when there is no filter
+ */
+template <typename Key, typename Hasher>
+BloomFilterStats BasicHashTable<Key, Hasher>::FilterStats() {
+    return filter != nullptr ? filter->GetStats() : BloomFilterStats();
+}
+
+/**
+ * Record later inserts and removes in a change log
+ *
+ * @param aLog Log to append to, or nullptr to stop recording. The
+ *        caller keeps ownership.
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::AttachLog(BidLog* aLog) {
+    log = aLog;
+}
+
+/**
+ * Refill the bloom filter from the stored bids, sized for a quarter
+ * more so growth does not make it stale again right away
+ */
+template <typename Key, typename Hasher>
+void BasicHashTable<Key, Hasher>::rebuildFilter() {
+    filter->Reset(max(Size() + Size() / 4, FILTER_MIN_KEYS));
+    for (const Table* current : { &table, &draining }) {
+        for (size_t i = 0; i < current->slots.size(); ++i) {
+            if (current->control[i] >= 0) {
+                filter->Add(current->slots[i].node->bid.bidId);
+            }
+        }
+    }
+}
+
+//============================================================================
+// Concurrent hash table class definition
+//============================================================================
+
+// independently locked shards of a concurrent table, a power of two
+const unsigned int HASH_SHARDS = 64;
+
+// seed of the hash that picks a shard, unrelated to the tables' own
+const uint64_t SHARD_SEED = 0x5348415244ULL;
+
+/**
+ * Define a class containing data members and methods to
+ * implement a hash table many threads can insert into, remove from
+ * and search at the same time.
+ *
+ * Bids are spread over HASH_SHARDS hash tables, each behind its own
+ * lock, by a hash with a different seed than the one the tables use
+ * inside; the hash policy must give unrelated hashes for different
+ * seeds. Threads only contend when they change the same shard, any
+ * number of them can search a shard at once, and a shard that grows
+ * only holds up callers of that shard.
+ */
+template <typename Key, typename Hasher = WyHash>
+class ConcurrentHashTable {
+
+private:
+    typedef BidKeyTraits<Key> Traits;
+
+    // one table and its lock, on cache lines of their own
+    struct alignas(64) Shard {
+        mutable shared_mutex lock;
+        BasicHashTable<Key, Hasher> table;
+    };
+
+    Hasher shardHasher;
+    Shard shards[HASH_SHARDS];
+
+    size_t shardOf(string_view bidId) const;
+
+public:
+    ConcurrentHashTable();
+    void Insert(Bid bid);
+    void Reserve(size_t bidCount);
+    void Remove(string_view bidId);
+    Bid Search(string_view bidId) const;
+    template <typename Visitor>
+    bool Visit(string_view bidId, Visitor visit) const;
+    size_t Size();
+};
+
+/**
+ * Default constructor
+ */
+template <typename Key, typename Hasher>
+ConcurrentHashTable<Key, Hasher>::ConcurrentHashTable() : shardHasher(SHARD_SEED) {
+}
+
+/**
+ * Index of the shard that holds a bid id
+ */
+template <typename Key, typename Hasher>
+size_t ConcurrentHashTable<Key, Hasher>::shardOf(string_view bidId) const {
+    return Traits::Hash(Traits::MakeProbe(bidId), shardHasher) & (HASH_SHARDS - 1);
+}
+
+/**
+ * Insert a bid
+ */
+template <typename Key, typename Hasher>
+void ConcurrentHashTable<Key, Hasher>::Insert(Bid bid) {
+    Shard& shard = shards[shardOf(bid.bidId)];
+    lock_guard<shared_mutex> lock(shard.lock);
+    shard.table.Insert(move(bid));
+}
+
+/**
+ * Make room for a number of bids up front, split evenly over the shards
+ *
+ * @param bidCount Total number of bids the table should hold
+ */
+template <typename Key, typename Hasher>
+void ConcurrentHashTable<Key, Hasher>::Reserve(size_t bidCount) {
+    // a little headroom since the shards never split bids exactly evenly
+    size_t perShard = bidCount / HASH_SHARDS + bidCount / HASH_SHARDS / 8 + 1;
+    for (Shard& shard : shards) {
+        lock_guard<shared_mutex> lock(shard.lock);
+        shard.table.Reserve(perShard);
+    }
+}
+
+/**
+ * Remove a bid
+ */
+template <typename Key, typename Hasher>
+void ConcurrentHashTable<Key, Hasher>::Remove(string_view bidId) {
+    Shard& shard = shards[shardOf(bidId)];
+    lock_guard<shared_mutex> lock(shard.lock);
+    shard.table.Remove(bidId);
+}
+
+/**
+ * Search for a bid
+ *
+ * @return A copy of the bid, or an empty bid when not found
+ */
+template <typename Key, typename Hasher>
+Bid ConcurrentHashTable<Key, Hasher>::Search(string_view bidId) const {
+    Bid bid;
+    Visit(bidId, [&bid](const Bid& found) {
+        bid = found;
+    });
+    return bid;
+}
+
+/**
+ * Look up a bid and hand it to a callback while its shard is locked
+ *
+ * The callback must not keep a pointer to the bid or call back into
+ * the table.
+ *
+ * @param bidId The bid id to search for
+ * @param visit Called with the bid when found
+ * @return True when the bid was found
+ */
+template <typename Key, typename Hasher>
+template <typename Visitor>
+bool ConcurrentHashTable<Key, Hasher>::Visit(string_view bidId, Visitor visit) const {
+    // lookups only count probes in relaxed atomics and the shards have
+    // no bloom filter, so readers of a shard share its lock
+    const Shard& shard = shards[shardOf(bidId)];
+    shared_lock<shared_mutex> lock(shard.lock);
+    const Bid* found = shard.table.Find(bidId);
+    if (found == nullptr) {
+        return false;
+    }
+    visit(*found);
+    return true;
+}
+
+/**
+ * Number of bids in the table, exact only while no thread changes it
+ */
+template <typename Key, typename Hasher>
+size_t ConcurrentHashTable<Key, Hasher>::Size() {
+    size_t total = 0;
+    for (Shard& shard : shards) {
+        lock_guard<shared_mutex> lock(shard.lock);
+        total += shard.table.Size();
+    }
+    return total;
+}
+
+//============================================================================
+// Static methods used for testing
+//============================================================================
+
+/**
+ * Display the bid information to the console (std::out)
+ *
+ * @param bid struct containing the bid info
+ */
+void displayBid(const Bid& bid) {
+    cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
+        << bid.fund << endl;
+}
+
+/**
+ * Display a bid read from a snapshot file to the console (std::out)
+ *
+ * @param bid The bid as it sits in the mapped file
+ */
+void displayBid(const MappedBids::BidView& bid) {
+    cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
+        << bid.fund << endl;
+}
+
+/**
+ * Display node allocator statistics to the console (std::out)
+ *
+ * @param stats Statistics reported by a NodePool
+ */
+void displayPoolStats(const NodePoolStats& stats) {
+    cout << "blocks: " << stats.blocks << " | live nodes: " << stats.liveNodes
+        << " | free nodes: " << stats.freeNodes << " | bytes: " << stats.bytes
+        << " | node size: " << stats.nodeBytes << endl;
+}
+
+/**
+ * Display hash table statistics to the console (std::out)
+ *
+ * @param stats Statistics reported by a hash table
+ */
+void displayTableStats(const HashTableStats& stats) {
+    cout << "bids: " << stats.size << " | slots: " << stats.capacity
+        << " | load factor: " << stats.loadFactor << " | longest probe: "
+        << stats.longestProbe << " groups" << endl;
+    cout << "bytes: " << stats.bytes << " | bytes per bid: "
+        << (stats.size > 0 ? double(stats.bytes) / stats.size : 0.0) << endl;
+
+    cout << "groups probed to reach a bid:" << endl;
+    for (size_t groups = 1; groups < stats.probeHistogram.size(); ++groups) {
+        if (stats.probeHistogram[groups] != 0) {
+            cout << "  " << groups << ": " << stats.probeHistogram[groups] << " bids" << endl;
+        }
+    }
+
+    const ProbeCounters& counters = stats.counters;
+    cout << "searches: " << counters.searches << " (" << counters.searchProbes << " groups probed)"
+        << " | inserts: " << counters.inserts << " (" << counters.insertProbes << ")"
+        << " | removes: " << counters.removes << " (" << counters.removeProbes << ")" << endl;
+}
+
+/**
+ * Display bloom filter statistics to the console (std::out)
+ *
+ * @param stats Statistics reported by a bloom filter
+ */
+void displayFilterStats(const BloomFilterStats& stats) {
+    unsigned long long misses = stats.rejected + stats.falsePositives;
+    cout << "filter: " << stats.keys << " of " << stats.capacity << " ids | "
+        << stats.bitsPerKey << " bits per id | " << stats.bytes << " bytes" << endl;
+    cout << "lookups: " << stats.queries << " | ruled out: " << stats.rejected
+        << " | false positives: " << stats.falsePositives << " ("
+        << (misses > 0 ? 100.0 * stats.falsePositives / misses : 0.0) << "% of misses)" << endl;
+}
+
+/**
+ * Load a CSV file containing bids into a container
+ *
+ * @param csvPath the path to the CSV file to load
+ * @return a container holding all the bids read
  */
-class HashTable {
+template <typename Table>
+void loadBids(string csvPath, Table* hashTable) {
+    cout << "Loading CSV file " << csvPath << endl;
 
-private:
-    // Define structures to hold bids
-    struct Node {
-        Bid bid;
-        unsigned int key;
-        Node* next;
+    // initialize the CSV Parser using the given path
+    csv::Parser file = csv::Parser(csvPath);
 
-        // default constructor
-        Node() {
-            key = UINT_MAX;
-            next = nullptr;
-        }
+    // read and display header row - optional
+    vector<string> header = file.getHeader();
+    for (auto const& c : header) {
+        cout << c << " | ";
+    }
+    cout << endl;
 
-        // initialize with a bid
-        Node(Bid aBid) : Node() {
-            bid = aBid;
-        }
+    // size the table for every row now instead of growing mid-load
+    hashTable->Reserve(file.rowCount());
 
-        // initialize with a bid and a key
-        Node(Bid aBid, unsigned int aKey) : Node(aBid) {
-            key = aKey;
-        }
-    };
+    try {
+        // loop to read rows of a CSV file
+        for (unsigned int i = 0; i < file.rowCount(); i++) {
 
-    vector<Node*> nodes;
+            // Create a data structure and add to the collection of bids
+            Bid bid;
+            bid.bidId = file[i][1];
+            bid.title = file[i][0];
+            bid.fund = file[i][8];
+            bid.amount = strToDouble(file[i][4], '$');
 
-    unsigned int tableSize = DEFAULT_SIZE;
+            // push this bid to the end
+            hashTable->Insert(move(bid));
+        }
+        cout << file.rowCount() << " bids read" << endl;
+    }
+    catch (csv::Error& e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
 
-    unsigned int hash(string bidId);
+/**
+ * Write every bid in a container to a snapshot file
+ *
+ * @param table The container to save
+ * @param path File to write
+ * @param sequence Last change log record the container includes
+ */
+template <typename Table>
+void saveSnapshot(Table* table, const string& path, uint64_t sequence = 0) {
+    vector<const Bid*> bids;
+    bids.reserve(table->Size());
+    table->ForEach([&bids](const Bid& bid) {
+        bids.push_back(&bid);
+    });
+    MappedBids::Write(path, move(bids), sequence);
+}
 
-public:
-    HashTable();
-    HashTable(unsigned int size);
-    virtual ~HashTable();
-    void Insert(Bid bid);
-    void PrintAll();
-    void Remove(string bidId);
-    Bid Search(string bidId);
-    size_t Size();
-};
+/**
+ * Save a snapshot of a container and empty its change log, so recovery
+ * only replays changes made after this point
+ *
+ * @param table The container to save
+ * @param log The container's change log
+ * @param snapshotPath File to write
+ */
+template <typename Table>
+void checkpoint(Table* table, BidLog* log, const string& snapshotPath) {
+    saveSnapshot(table, snapshotPath, log->Sequence());
+    log->Reset();
+}
 
 /**
- * Default constructor
+ * Rebuild a container from its last snapshot and the changes logged
+ * after it, instead of reloading the CSV file
+ *
+ * @param table The container to fill
+ * @param snapshotPath Snapshot file, may be missing
+ * @param logPath Change log file, may be missing
+ * @return Sequence number of the last change applied
  */
-HashTable::HashTable() {
-    // Initialize the structures used to hold bids
-    nodes.resize(tableSize, nullptr);
+template <typename Table>
+uint64_t recoverBids(Table* table, const string& snapshotPath, const string& logPath) {
+    MappedBids snapshot;
+    if (ifstream(snapshotPath).good()) {
+        snapshot.Open(snapshotPath);
+        table->Reserve(snapshot.Size());
+        for (size_t i = 0; i < snapshot.Size(); ++i) {
+            MappedBids::BidView view = snapshot.At(i);
+            Bid bid;
+            bid.bidId = string(view.bidId);
+            bid.title = string(view.title);
+            bid.fund = string(view.fund);
+            bid.amount = view.amount;
+            table->Insert(move(bid));
+        }
+    }
+
+    unsigned int changes = 0;
+    uint64_t sequence = BidLog::Replay<Bid>(logPath, snapshot.Sequence(),
+        [table, &changes](Bid&& bid) {
+            table->Insert(move(bid));
+            ++changes;
+        },
+        [table, &changes](string_view bidId) {
+            table->Remove(bidId);
+            ++changes;
+        });
+
+    if (snapshot.Size() > 0 || changes > 0) {
+        cout << snapshot.Size() << " bids recovered from " << snapshotPath << ", "
+            << changes << " changes replayed from " << logPath << endl;
+    }
+    return sequence;
 }
 
 /**
- * Constructor for specifying size of the table
- * Use to improve efficiency of hashing algorithm
- * by reducing collisions without wasting memory.
+ * Simple C function to convert a string to a double
+ * after stripping out unwanted char
+ *
+ * credit: http://stackoverflow.com/a/24875936
+ *
+ * @param ch The character to strip out
  */
-HashTable::HashTable(unsigned int size) {
-    tableSize = size;
-    nodes.resize(tableSize, nullptr);
+double strToDouble(string str, char ch) {
+    str.erase(remove(str.begin(), str.end(), ch), str.end());
+    return atof(str.c_str());
 }
 
+//============================================================================
+// Benchmarks
+//============================================================================
+
 /**
- * Destructor
+ * Time a hash policy on a set of ids and measure how evenly it spreads
+ * them over a table
+ *
+ * Spread is the chi-squared statistic of ids per first probed slot
+ * divided by the slot count: about 1.0 for a random hash, larger when
+ * ids cluster. The ids are also loaded into a table to show the probe
+ * lengths that result.
+ *
+ * @param name Label for the output
+ * @param ids Ids to hash
+ * @param hasher Hash policy to measure
  */
-HashTable::~HashTable() {
-    // Implement logic to free storage when class is destroyed
-    for (auto& node : nodes) {
-        while (node != nullptr) {
-            Node* temp = node;
-            node = node->next;
-            delete temp;
+template <typename Hasher>
+void benchmarkHash(const string& name, const vector<string>& ids, const Hasher& hasher) {
+    const int rounds = 10;
+    unsigned int combined = 0;
+    clock_t ticks = clock();
+    for (int round = 0; round < rounds; ++round) {
+        for (const string& id : ids) {
+            combined += BidKeyTraits<string>::Hash(id, hasher);
         }
     }
+    ticks = clock() - ticks;
+    double nanos = ticks * 1.0e9 / CLOCKS_PER_SEC / (double(rounds) * ids.size());
+
+    // a table of this size picks the first slot from the bits above the tag
+    size_t slots = GROUP_WIDTH;
+    while (slots < ids.size()) {
+        slots *= 2;
+    }
+    vector<unsigned int> idsPerSlot(slots, 0);
+    for (const string& id : ids) {
+        ++idsPerSlot[(BidKeyTraits<string>::Hash(id, hasher) >> 7) & (slots - 1)];
+    }
+    double expected = double(ids.size()) / slots;
+    double chiSquared = 0.0;
+    for (unsigned int idCount : idsPerSlot) {
+        chiSquared += (idCount - expected) * (idCount - expected) / expected;
+    }
+
+    BasicHashTable<string, Hasher>* table = new BasicHashTable<string, Hasher>(DEFAULT_SIZE, hasher);
+    table->Reserve(ids.size());
+    for (const string& id : ids) {
+        Bid bid;
+        bid.bidId = id;
+        table->Insert(move(bid));
+    }
+    HashTableStats stats = table->Stats();
+    delete table;
+
+    size_t totalProbes = 0;
+    for (size_t groups = 1; groups < stats.probeHistogram.size(); ++groups) {
+        totalProbes += groups * stats.probeHistogram[groups];
+    }
+
+    cout << name << ": " << nanos << " ns/hash | spread " << chiSquared / slots
+        << " | mean probe " << double(totalProbes) / stats.size << " groups | longest probe "
+        << stats.longestProbe << " groups | check " << combined << endl;
 }
 
 /**
- * Calculate the hash value of a given key.
+ * Compare the original multiply-by-31 hash and wyhash on sequential
+ * numeric ids, like the eBid ids, and on random alphanumeric ids
  *
- * @param bidId The key to hash
- * @return The calculated hash
+ * @param count Number of ids in each set
  */
-unsigned int HashTable::hash(string bidId) {
-    unsigned int hashValue = 0;
-    for (char ch : bidId) {
-        hashValue = (hashValue * 31) + ch;
+void benchmarkHashFunctions(unsigned int count) {
+    vector<string> sequential, random;
+    const char alphabet[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    mt19937 rng(304);
+    for (unsigned int i = 0; i < count; ++i) {
+        sequential.push_back(to_string(10000000 + i));
+
+        string id;
+        for (int j = 0; j < 8; ++j) {
+            id += alphabet[rng() % (sizeof(alphabet) - 1)];
+        }
+        random.push_back(id);
     }
-    return hashValue % tableSize;
+
+    cout << "sequential ids:" << endl;
+    benchmarkHash("  multiply by 31", sequential, MultiplyHash());
+    benchmarkHash("  wyhash", sequential, WyHash());
+    cout << "random ids:" << endl;
+    benchmarkHash("  multiply by 31", random, MultiplyHash());
+    benchmarkHash("  wyhash", random, WyHash());
 }
 
 /**
- * Insert a bid
+ * Run threads against a concurrent table at several read/write mixes,
+ * reporting throughput and speedup over one thread for each thread
+ * count
  *
- * @param bid The bid to insert
+ * Each thread looks up preloaded ids and, for its share of writes,
+ * inserts or removes ids in a range of its own, so every lookup must
+ * succeed; any miss is reported as an error. Times are wall clock
+ * since clock() adds up the CPU time of every thread.
+ *
+ * @param count Number of bids loaded before the threads start
  */
-void HashTable::Insert(Bid bid) {
-    // Implement logic to insert a bid
-    unsigned int key = hash(bid.bidId);
-    Node* newNode = new Node(bid, key);
+void benchmarkConcurrentTable(unsigned int count) {
+    const chrono::milliseconds duration(1000);
+    const unsigned int writePercents[] = { 0, 10, 50 };
 
-    if (nodes[key] == nullptr) {
-        nodes[key] = newNode;
+    vector<string> ids;
+    ConcurrentHashTable<uint64_t>* table = new ConcurrentHashTable<uint64_t>();
+    table->Reserve(count);
+    for (unsigned int i = 0; i < count; ++i) {
+        Bid bid;
+        bid.bidId = to_string(10000000 + i);
+        ids.push_back(bid.bidId);
+        table->Insert(move(bid));
     }
-    else {
-        Node* current = nodes[key];
-        while (current->next != nullptr) {
-            current = current->next;
+
+    unsigned int maxThreads = max(1u, thread::hardware_concurrency());
+    vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    for (unsigned int writePercent : writePercents) {
+        cout << writePercent << "% writes:" << endl;
+
+        double baseRate = 0.0;
+        for (unsigned int threads : threadCounts) {
+            atomic<bool> stop(false);
+            atomic<unsigned long long> operations(0), errors(0);
+
+            vector<thread> workers;
+            auto start = chrono::steady_clock::now();
+            for (unsigned int t = 0; t < threads; ++t) {
+                workers.emplace_back([&, t]() {
+                    mt19937 rng(500 + t);
+                    unsigned long long done = 0, missing = 0;
+                    unsigned int next = 0;
+                    while (!stop.load(memory_order_relaxed)) {
+                        if (rng() % 100 < writePercent) {
+                            // alternate runs of inserts and removes over 1000 ids
+                            Bid bid;
+                            bid.bidId = to_string(30000000 + t * 1000 + next % 1000);
+                            if ((next / 1000) % 2 == 0) {
+                                table->Insert(move(bid));
+                            }
+                            else {
+                                table->Remove(bid.bidId);
+                            }
+                            ++next;
+                        }
+                        else if (!table->Visit(ids[rng() % ids.size()], [](const Bid&) {})) {
+                            ++missing;
+                        }
+                        ++done;
+                    }
+                    operations.fetch_add(done);
+                    errors.fetch_add(missing);
+                });
+            }
+
+            this_thread::sleep_for(duration);
+            stop = true;
+            for (thread& worker : workers) {
+                worker.join();
+            }
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+            double rate = operations.load() / seconds;
+            if (baseRate == 0.0) {
+                baseRate = rate;
+            }
+            cout << "  " << threads << " threads: " << rate / 1e6 << " M ops/s | speedup "
+                << rate / baseRate << "x | " << errors.load() << " errors" << endl;
         }
-        current->next = newNode;
     }
+
+    delete table;
 }
 
 /**
- * Print all bids
+ * Compare looking up ids one at a time with Find against SearchBatch,
+ * on a table much larger than the processor caches
+ *
+ * @param count Number of bids to load
  */
-void HashTable::PrintAll() {
-    // Implement logic to print all bids
-    for (unsigned int i = 0; i < nodes.size(); ++i) {
-        Node* current = nodes[i];
-        while (current != nullptr) {
-            cout << "Key " << i << ": " << current->bid.bidId << " | " << current->bid.title << " | " << current->bid.amount << " | " << current->bid.fund << endl;
-            current = current->next;
+void benchmarkBatchLookups(unsigned int count) {
+    NumericHashTable* table = new NumericHashTable();
+    table->Reserve(count);
+    vector<string> ids;
+    for (unsigned int i = 0; i < count; ++i) {
+        Bid bid;
+        bid.bidId = to_string(10000000 + i);
+        ids.push_back(bid.bidId);
+        table->Insert(move(bid));
+    }
+
+    mt19937 rng(305);
+    shuffle(ids.begin(), ids.end(), rng);
+    vector<string_view> keys(ids.begin(), ids.end());
+    vector<const Bid*> found(keys.size());
+
+    clock_t ticks = clock();
+    for (size_t i = 0; i < keys.size(); ++i) {
+        found[i] = table->Find(keys[i]);
+    }
+    ticks = clock() - ticks;
+    size_t hits = count_if(found.begin(), found.end(), [](const Bid* bid) { return bid != nullptr; });
+    cout << "one at a time: " << ticks * 1.0e9 / CLOCKS_PER_SEC / keys.size() << " ns per id ("
+        << hits << " found)" << endl;
+
+    fill(found.begin(), found.end(), nullptr);
+    ticks = clock();
+    table->SearchBatch(keys.data(), keys.size(), found.data());
+    ticks = clock() - ticks;
+    hits = count_if(found.begin(), found.end(), [](const Bid* bid) { return bid != nullptr; });
+    cout << "batched: " << ticks * 1.0e9 / CLOCKS_PER_SEC / keys.size() << " ns per id ("
+        << hits << " found)" << endl;
+
+    delete table;
+}
+
+/**
+ * Time Find over a set of ids
+ *
+ * @param found Receives the number of ids found
+ * @return Average nanoseconds per lookup
+ */
+template <typename Table>
+double timeLookups(const Table* table, const vector<string>& ids, unsigned int& found) {
+    found = 0;
+    clock_t ticks = clock();
+    for (const string& id : ids) {
+        if (table->Find(id) != nullptr) {
+            ++found;
         }
     }
+    ticks = clock() - ticks;
+    return ticks * 1.0e9 / CLOCKS_PER_SEC / ids.size();
 }
 
 /**
- * Remove a bid
+ * Time lookups of missing and stored ids without a bloom filter and
+ * with filters of several sizes
  *
- * @param bidId The bid id to search for
+ * @param count Number of bids to load
  */
-void HashTable::Remove(string bidId) {
-    // Implement logic to remove a bid
-    unsigned int key = hash(bidId);
-    Node* current = nodes[key];
-    Node* prev = nullptr;
+void benchmarkBloomFilter(unsigned int count) {
+    const double bitsPerKey[] = { 0, 4, 8, 12, 16 };
 
-    while (current != nullptr && current->bid.bidId != bidId) {
-        prev = current;
-        current = current->next;
+    NumericHashTable* table = new NumericHashTable();
+    table->Reserve(count);
+    vector<string> hits, misses;
+    for (unsigned int i = 0; i < count; ++i) {
+        Bid bid;
+        bid.bidId = to_string(10000000 + i);
+        hits.push_back(bid.bidId);
+        misses.push_back(to_string(20000000 + i));
+        table->Insert(move(bid));
     }
+    mt19937 rng(307);
+    shuffle(hits.begin(), hits.end(), rng);
+    shuffle(misses.begin(), misses.end(), rng);
 
-    if (current != nullptr) {
-        if (prev == nullptr) {
-            nodes[key] = current->next;
+    for (double bits : bitsPerKey) {
+        if (bits == 0) {
+            table->DisableFilter();
+            cout << "no filter:" << endl;
         }
         else {
-            prev->next = current->next;
+            table->EnableFilter(bits);
+            cout << bits << " bits per id:" << endl;
+        }
+
+        unsigned int found;
+        double nanos = timeLookups(table, misses, found);
+        cout << "  miss " << nanos << " ns (" << found << " found)";
+        nanos = timeLookups(table, hits, found);
+        cout << " | hit " << nanos << " ns (" << found << " found)" << endl;
+        if (bits != 0) {
+            displayFilterStats(table->FilterStats());
         }
-        delete current;
     }
+
+    delete table;
 }
 
 /**
- * Search for the specified bidId
+ * Time a cold start from a snapshot file against inserting every bid,
+ * and lookups in the mapped file against the table
  *
- * @param bidId The bid id to search for
+ * @param count Number of bids to load
  */
-Bid HashTable::Search(string bidId) {
-    Bid bid;
-    // Implement logic to search for and return a bid
-    unsigned int key = hash(bidId);
-    Node* current = nodes[key];
+void benchmarkSnapshot(unsigned int count) {
+    const string path = "benchmark.snap";
+
+    NumericHashTable* table = new NumericHashTable();
+    vector<string> ids;
+    clock_t ticks = clock();
+    table->Reserve(count);
+    for (unsigned int i = 0; i < count; ++i) {
+        Bid bid;
+        bid.bidId = to_string(10000000 + i);
+        bid.title = "Benchmark bid title " + bid.bidId;
+        bid.fund = "General Fund";
+        bid.amount = i % 1000;
+        ids.push_back(bid.bidId);
+        table->Insert(move(bid));
+    }
+    ticks = clock() - ticks;
+    cout << "insert " << count << " bids: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+    ticks = clock();
+    saveSnapshot(table, path);
+    ticks = clock() - ticks;
+    cout << "write snapshot: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+    MappedBids snapshot;
+    for (bool verify : { true, false }) {
+        ticks = clock();
+        snapshot.Open(path, verify);
+        ticks = clock() - ticks;
+        cout << "open snapshot" << (verify ? " and verify checksum" : "") << ": "
+            << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+    }
 
-    while (current != nullptr) {
-        if (current->bid.bidId == bidId) {
-            return current->bid;
+    mt19937 rng(409);
+    shuffle(ids.begin(), ids.end(), rng);
+    unsigned int found;
+    double nanos = timeLookups(table, ids, found);
+    cout << "table lookup " << nanos << " ns (" << found << " found)";
+    found = 0;
+    ticks = clock();
+    MappedBids::BidView bid;
+    for (const string& id : ids) {
+        if (snapshot.Find(id, bid)) {
+            ++found;
         }
-        current = current->next;
     }
+    ticks = clock() - ticks;
+    cout << " | snapshot lookup " << ticks * 1.0e9 / CLOCKS_PER_SEC / ids.size() << " ns ("
+        << found << " found)" << endl;
 
-    return bid;
+    snapshot.Close();
+    remove(path.c_str());
+    delete table;
 }
 
-//============================================================================
-// Static methods used for testing
-//============================================================================
-
 /**
- * Display the bid information to the console (std::out)
+ * Time Remove without a change log, with a log that syncs every change
+ * and with group commits, then time recovering the table from the
+ * snapshot and log
  *
- * @param bid struct containing the bid info
+ * @param count Number of bids to load
+ * @param removes Number of bids to remove in each run
  */
-void displayBid(Bid bid) {
-    cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
-        << bid.fund << endl;
+void benchmarkChangeLog(unsigned int count, unsigned int removes) {
+    const string snapshotPath = "benchmark.snap";
+    const string logPath = "benchmark.log";
+    const unsigned int groupMillis[] = { 0, 5 };
+
+    vector<string> ids;
+    for (unsigned int i = 0; i < count; ++i) {
+        ids.push_back(to_string(10000000 + i));
+    }
+    mt19937 rng(410);
+    shuffle(ids.begin(), ids.end(), rng);
+
+    for (int run = -1; run < 2; ++run) {
+        NumericHashTable* table = new NumericHashTable();
+        table->Reserve(count);
+        for (const string& id : ids) {
+            Bid bid;
+            bid.bidId = id;
+            bid.title = "Benchmark bid title " + id;
+            bid.fund = "General Fund";
+            table->Insert(move(bid));
+        }
+
+        BidLog* log = nullptr;
+        if (run >= 0) {
+            remove(logPath.c_str());
+            log = new BidLog(logPath, 0, groupMillis[run]);
+            checkpoint(table, log, snapshotPath);
+            table->AttachLog(log);
+        }
+
+        auto start = chrono::steady_clock::now();
+        for (unsigned int i = 0; i < removes; ++i) {
+            table->Remove(ids[i]);
+        }
+        if (log != nullptr) {
+            log->Sync();
+        }
+        double nanos = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+        if (run < 0) {
+            cout << "no log:";
+        }
+        else if (groupMillis[run] == 0) {
+            cout << "sync every change:";
+        }
+        else {
+            cout << "group commit every " << groupMillis[run] << " ms:";
+        }
+        cout << " remove " << nanos / removes << " ns";
+        if (log != nullptr) {
+            BidLogStats stats = log->GetStats();
+            cout << " | " << stats.records << " changes in " << stats.syncs << " syncs";
+        }
+        cout << endl;
+
+        delete log;
+        delete table;
+    }
+
+    // the last run left a snapshot and a log of its removes
+    NumericHashTable* recovered = new NumericHashTable();
+    clock_t ticks = clock();
+    recoverBids(recovered, snapshotPath, logPath);
+    ticks = clock() - ticks;
+    cout << "recover " << recovered->Size() << " bids: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+    delete recovered;
+    remove(snapshotPath.c_str());
+    remove(logPath.c_str());
 }
 
 /**
- * Load a CSV file containing bids into a container
- *
- * @param csvPath the path to the CSV file to load
- * @return a container holding all the bids read
+ * Benchmark menu
  */
-void loadBids(string csvPath, HashTable* hashTable) {
-    cout << "Loading CSV file " << csvPath << endl;
+void runBenchmarks() {
+    cout << "Benchmarks:" << endl;
+    cout << "  1. Hash Functions" << endl;
+    cout << "  2. Concurrent Table" << endl;
+    cout << "  3. Batch Lookups" << endl;
+    cout << "  4. Bloom Filter" << endl;
+    cout << "  5. Snapshot File" << endl;
+    cout << "  6. Change Log" << endl;
+    cout << "Enter choice: ";
 
-    // initialize the CSV Parser using the given path
-    csv::Parser file = csv::Parser(csvPath);
+    int choice = 0;
+    cin >> choice;
 
-    // read and display header row - optional
-    vector<string> header = file.getHeader();
-    for (auto const& c : header) {
-        cout << c << " | ";
-    }
-    cout << endl;
+    switch (choice) {
+    case 1:
+        benchmarkHashFunctions(BENCHMARK_SIZE);
+        break;
 
-    try {
-        // loop to read rows of a CSV file
-        for (unsigned int i = 0; i < file.rowCount(); i++) {
+    case 2:
+        benchmarkConcurrentTable(BENCHMARK_SIZE);
+        break;
 
-            // Create a data structure and add to the collection of bids
-            Bid bid;
-            bid.bidId = file[i][1];
-            bid.title = file[i][0];
-            bid.fund = file[i][8];
-            bid.amount = strToDouble(file[i][4], '$');
+    case 3:
+        benchmarkBatchLookups(BENCHMARK_SIZE);
+        break;
 
-            // push this bid to the end
-            hashTable->Insert(bid);
-        }
-        cout << file.rowCount() << " bids read" << endl;
-    }
-    catch (csv::Error& e) {
-        std::cerr << e.what() << std::endl;
+    case 4:
+        benchmarkBloomFilter(BENCHMARK_SIZE);
+        break;
+
+    case 5:
+        benchmarkSnapshot(BENCHMARK_SIZE);
+        break;
+
+    case 6:
+        benchmarkChangeLog(BENCHMARK_SIZE, LOG_REMOVES);
+        break;
     }
 }
 
 /**
- * Simple C function to convert a string to a double
- * after stripping out unwanted char
- *
- * credit: http://stackoverflow.com/a/24875936
+ * Snapshot file menu
  *
- * @param ch The character to strip out
+ * @param bidTable Bids to save
+ * @param changeLog The table's change log, emptied by a save
+ * @param snapshot Mapped snapshot, kept open between calls
+ * @param path Snapshot file to save and open
+ * @param bidKey Bid id to find
  */
-double strToDouble(string str, char ch) {
-    str.erase(remove(str.begin(), str.end(), ch), str.end());
-    return atof(str.c_str());
+void runSnapshots(NumericHashTable* bidTable, BidLog* changeLog, MappedBids& snapshot, const string& path,
+    const string& bidKey) {
+    cout << "Snapshot " << path << ":" << endl;
+    cout << "  1. Save Snapshot" << endl;
+    cout << "  2. Open Snapshot" << endl;
+    cout << "  3. Find Bid In Snapshot" << endl;
+    cout << "Enter choice: ";
+
+    int choice = 0;
+    cin >> choice;
+
+    clock_t ticks = clock();
+    try {
+        switch (choice) {
+        case 1:
+            snapshot.Close();
+            checkpoint(bidTable, changeLog, path);
+            cout << bidTable->Size() << " bids saved" << endl;
+            break;
+
+        case 2:
+            snapshot.Open(path);
+            cout << snapshot.Size() << " bids mapped" << endl;
+            break;
+
+        case 3: {
+            MappedBids::BidView bid;
+            if (snapshot.Find(bidKey, bid)) {
+                displayBid(bid);
+            }
+            else {
+                cout << "Bid Id " << bidKey << " not found." << endl;
+            }
+            break;
+        }
+
+        default:
+            return;
+        }
+    }
+    catch (runtime_error& e) {
+        cerr << e.what() << endl;
+    }
+    ticks = clock() - ticks;
+    cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
 }
 
 /**
@@ -307,18 +1800,44 @@ int main(int argc, char* argv[]) {
     // Define a timer variable
     clock_t ticks;
 
-    // Define a hash table to hold all the bids
-    HashTable* bidTable = new HashTable();
+    // Define a hash table to hold all the bids, keyed on the integer
+    // value of the numeric bid ids
+    NumericHashTable* bidTable = new NumericHashTable();
 
-    Bid bid;
+    // snapshot file of the table, mapped and searched in place
+    MappedBids snapshot;
+
+    // pick up where the last run left off, then log every change so
+    // the next run can too
+    string snapshotPath = csvPath + ".snap";
+    string logPath = csvPath + ".log";
+    BidLog* changeLog = nullptr;
+    try {
+        uint64_t sequence = recoverBids(bidTable, snapshotPath, logPath);
+        changeLog = new BidLog(logPath, sequence);
+        if (changeLog->GetStats().bytes > 0) {
+            checkpoint(bidTable, changeLog, snapshotPath);
+        }
+        bidTable->AttachLog(changeLog);
+    }
+    catch (runtime_error& e) {
+        cerr << e.what() << endl;
+        cerr << "changes will not be saved" << endl;
+    }
+
+    const Bid* bid;
 
     int choice = 0;
     while (choice != 9) {
         cout << "Menu:" << endl;
-        cout << "  1. Load Bids" << endl;
+        cout << "  1. Load Bids (replaces recovered bids)" << endl;
         cout << "  2. Display All Bids" << endl;
         cout << "  3. Find Bid" << endl;
         cout << "  4. Remove Bid" << endl;
+        cout << "  5. Show Allocator Stats" << endl;
+        cout << "  6. Show Table Stats" << endl;
+        cout << "  7. Run Benchmarks" << endl;
+        cout << "  8. Snapshot File" << endl;
         cout << "  9. Exit" << endl;
         cout << "Enter choice: ";
         cin >> choice;
@@ -328,8 +1847,23 @@ int main(int argc, char* argv[]) {
             // Initialize a timer variable before loading bids
             ticks = clock();
 
-            // Complete the method call to load the bids
+            // Complete the method call to load the bids, a checkpoint
+            // saves them instead of logging every row. The CSV file
+            // replaces the recovered bids rather than adding to them,
+            // which would duplicate them and bring back removed ones
+            delete bidTable;
+            bidTable = new NumericHashTable();
             loadBids(csvPath, bidTable);
+            bidTable->AttachLog(changeLog);
+            if (changeLog != nullptr) {
+                try {
+                    snapshot.Close();
+                    checkpoint(bidTable, changeLog, snapshotPath);
+                }
+                catch (runtime_error& e) {
+                    cerr << e.what() << endl;
+                }
+            }
 
             // Calculate elapsed time and display result
             ticks = clock() - ticks; // current clock ticks minus starting clock ticks
@@ -344,12 +1878,12 @@ int main(int argc, char* argv[]) {
         case 3:
             ticks = clock();
 
-            bid = bidTable->Search(bidKey);
+            bid = bidTable->Find(bidKey);
 
             ticks = clock() - ticks; // current clock ticks minus starting clock ticks
 
-            if (!bid.bidId.empty()) {
-                displayBid(bid);
+            if (bid != nullptr) {
+                displayBid(*bid);
             }
             else {
                 cout << "Bid Id " << bidKey << " not found." << endl;
@@ -362,11 +1896,55 @@ int main(int argc, char* argv[]) {
         case 4:
             bidTable->Remove(bidKey);
             break;
+
+        case 5:
+            displayPoolStats(bidTable->AllocatorStats());
+            break;
+
+        case 6:
+            displayTableStats(bidTable->Stats());
+            break;
+
+        case 7:
+            runBenchmarks();
+            break;
+
+        case 8:
+            if (changeLog != nullptr) {
+                runSnapshots(bidTable, changeLog, snapshot, snapshotPath, bidKey);
+            }
+            break;
+        }
+
+        // report changes the log could not save, and replace a long
+        // change log with a snapshot now and then
+        if (changeLog != nullptr) {
+            try {
+                changeLog->Check();
+                if (changeLog->NeedsCheckpoint()) {
+                    snapshot.Close();
+                    checkpoint(bidTable, changeLog, snapshotPath);
+                }
+            }
+            catch (runtime_error& e) {
+                cerr << e.what() << endl;
+            }
         }
     }
 
     cout << "Good bye." << endl;
 
+    // sync the last changes, the destructor cannot report a failure
+    if (changeLog != nullptr) {
+        try {
+            changeLog->Sync();
+        }
+        catch (runtime_error& e) {
+            cerr << e.what() << endl;
+            cerr << "the last changes were not saved" << endl;
+        }
+    }
+    delete changeLog;
     delete bidTable;
     return 0;
 }
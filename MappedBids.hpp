@@ -0,0 +1,441 @@
+//============================================================================
+// Name        : MappedBids.hpp
+// Author      : Joshua Hale
+// Version     : 1.2
+// Description : Binary bid snapshot files queried in place through mmap
+//============================================================================
+
+#ifndef MAPPEDBIDS_HPP
+#define MAPPEDBIDS_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "BidHash.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/**
+ * A snapshot file holds bids with offsets in place of pointers, so it
+ * can be mapped into memory and searched right away:
+ *
+ *   header   magic, version, log sequence, section offsets, checksum
+ *            of the whole file
+ *   records  one fixed size record per bid, sorted by id
+ *   slots    open addressed index of record numbers plus one, 0 empty
+ *   heap     the id, title and fund strings the records point into
+ *
+ * Numbers are stored in the byte order of the machine that wrote the
+ * file; the magic number doubles as a check for that.
+ */
+class MappedBids {
+
+public:
+    static const uint32_t VERSION = 3;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t endianCheck;
+        uint64_t sequence;
+        uint64_t count;
+        uint64_t slotCount;
+        uint64_t recordsOffset;
+        uint64_t slotsOffset;
+        uint64_t heapOffset;
+        uint64_t fileBytes;
+        uint64_t checksum;
+    };
+
+    struct Record {
+        uint32_t idOffset;
+        uint32_t idLength;
+        uint32_t titleOffset;
+        uint32_t titleLength;
+        uint32_t fundOffset;
+        uint32_t fundLength;
+        double amount;
+    };
+
+    // a bid read straight out of the mapped file, valid while it is open
+    struct BidView {
+        std::string_view bidId;
+        std::string_view title;
+        std::string_view fund;
+        double amount = 0.0;
+    };
+
+private:
+    static constexpr char MAGIC[8] = { 'B', 'I', 'D', 'S', 'N', 'A', 'P', '\0' };
+    static const uint32_t ENDIAN_CHECK = 0x01020304;
+    static const uint64_t SEED = 0x534e4150ULL;
+
+    const char* data;
+    size_t length;
+    const Header* header;
+    const Record* records;
+    const uint32_t* slots;
+    const char* heap;
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+    std::string_view text(uint32_t offset, uint32_t size) const {
+        return std::string_view(heap + offset, size);
+    }
+
+    /**
+     * Checksum of a whole file image, the header included with its
+     * checksum field taken as 0
+     */
+    static uint64_t checksum(const char* image, size_t size) {
+        Header fields;
+        std::memcpy(&fields, image, sizeof(Header));
+        fields.checksum = 0;
+        uint64_t body = WyHash(SEED).Bytes(std::string_view(image + sizeof(Header), size - sizeof(Header)));
+        return WyHash(body).Bytes(std::string_view(reinterpret_cast<const char*>(&fields), sizeof(Header)));
+    }
+
+    static void fail(const std::string& path, const char* reason) {
+        throw std::runtime_error("snapshot " + path + ": " + reason);
+    }
+
+    /**
+     * Write a whole file and flush it to the disk
+     */
+    static bool writeDurably(const std::string& path, const std::string& bytes) {
+#if defined(_WIN32)
+        HANDLE out = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (out == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        bool written = true;
+        for (size_t done = 0; written && done < bytes.size();) {
+            DWORD chunk = static_cast<DWORD>(std::min<size_t>(bytes.size() - done, 1 << 30));
+            DWORD count = 0;
+            written = WriteFile(out, bytes.data() + done, chunk, &count, nullptr) != 0;
+            done += count;
+        }
+        written = written && FlushFileBuffers(out) != 0;
+        CloseHandle(out);
+#else
+        int out = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out < 0) {
+            return false;
+        }
+        bool written = true;
+        for (size_t done = 0; written && done < bytes.size();) {
+            ssize_t count = write(out, bytes.data() + done, bytes.size() - done);
+            written = count > 0;
+            done += written ? static_cast<size_t>(count) : 0;
+        }
+        written = written && fsync(out) == 0;
+        written = close(out) == 0 && written;
+#endif
+        return written;
+    }
+
+#if !defined(_WIN32)
+    /**
+     * Flush the directory holding a file to the disk
+     */
+    static bool syncDirectory(const std::string& path) {
+        size_t slash = path.find_last_of('/');
+        std::string directory = slash == std::string::npos ? "." : path.substr(0, slash > 0 ? slash : 1);
+        int dir = open(directory.c_str(), O_RDONLY | O_DIRECTORY);
+        if (dir < 0) {
+            return false;
+        }
+        bool synced = fsync(dir) == 0;
+        return close(dir) == 0 && synced;
+    }
+#endif
+
+public:
+    MappedBids() {
+        data = nullptr;
+        length = 0;
+        header = nullptr;
+        records = nullptr;
+        slots = nullptr;
+        heap = nullptr;
+#if defined(_WIN32)
+        file = INVALID_HANDLE_VALUE;
+        mapping = nullptr;
+#endif
+    }
+
+    MappedBids(const MappedBids&) = delete;
+    MappedBids& operator=(const MappedBids&) = delete;
+
+    ~MappedBids() {
+        Close();
+    }
+
+    /**
+     * Map a snapshot file and check its header
+     *
+     * @param path File written by Write
+     * @param verify Also check the checksum, which reads every page
+     * @throws std::runtime_error when the file is missing or invalid
+     */
+    void Open(const std::string& path, bool verify = true) {
+        Close();
+
+#if defined(_WIN32)
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            fail(path, "cannot open");
+        }
+        LARGE_INTEGER size;
+        GetFileSizeEx(file, &size);
+        length = static_cast<size_t>(size.QuadPart);
+        if (length >= sizeof(Header)) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping != nullptr) {
+                data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            }
+        }
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            fail(path, "cannot open");
+        }
+        struct stat info;
+        fstat(fd, &info);
+        length = static_cast<size_t>(info.st_size);
+        if (length >= sizeof(Header)) {
+            void* mapped = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+            data = mapped != MAP_FAILED ? static_cast<const char*>(mapped) : nullptr;
+        }
+        close(fd);
+#endif
+        if (data == nullptr) {
+            Close();
+            fail(path, "cannot map or too short");
+        }
+
+        header = reinterpret_cast<const Header*>(data);
+        const char* reason = nullptr;
+        if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0) {
+            reason = "not a snapshot file";
+        }
+        else if (header->endianCheck != ENDIAN_CHECK) {
+            reason = "written on a machine of another byte order";
+        }
+        else if (header->version != VERSION) {
+            reason = "unsupported version";
+        }
+        else if (header->fileBytes != length || header->recordsOffset != sizeof(Header)
+            || header->slotsOffset != header->recordsOffset + header->count * sizeof(Record)
+            || header->heapOffset != header->slotsOffset + header->slotCount * sizeof(uint32_t)
+            || header->heapOffset > length || header->slotCount == 0
+            || (header->slotCount & (header->slotCount - 1)) != 0) {
+            reason = "truncated or corrupt layout";
+        }
+        else if (verify && checksum(data, length) != header->checksum) {
+            reason = "checksum mismatch";
+        }
+        if (reason != nullptr) {
+            Close();
+            fail(path, reason);
+        }
+
+        records = reinterpret_cast<const Record*>(data + header->recordsOffset);
+        slots = reinterpret_cast<const uint32_t*>(data + header->slotsOffset);
+        heap = data + header->heapOffset;
+    }
+
+    /**
+     * Unmap the file, every BidView taken from it becomes invalid
+     */
+    void Close() {
+#if defined(_WIN32)
+        if (data != nullptr) {
+            UnmapViewOfFile(data);
+        }
+        if (mapping != nullptr) {
+            CloseHandle(mapping);
+        }
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (data != nullptr) {
+            munmap(const_cast<char*>(data), length);
+        }
+#endif
+        data = nullptr;
+        length = 0;
+        header = nullptr;
+        records = nullptr;
+        slots = nullptr;
+        heap = nullptr;
+    }
+
+    bool IsOpen() const {
+        return data != nullptr;
+    }
+
+    size_t Size() const {
+        return header != nullptr ? static_cast<size_t>(header->count) : 0;
+    }
+
+    /**
+     * Last change log record the snapshot includes, 0 when none
+     */
+    uint64_t Sequence() const {
+        return header != nullptr ? header->sequence : 0;
+    }
+
+    /**
+     * Bid at a position in id order
+     */
+    BidView At(size_t index) const {
+        const Record& record = records[index];
+        BidView bid;
+        bid.bidId = text(record.idOffset, record.idLength);
+        bid.title = text(record.titleOffset, record.titleLength);
+        bid.fund = text(record.fundOffset, record.fundLength);
+        bid.amount = record.amount;
+        return bid;
+    }
+
+    /**
+     * Look up a bid through the slot index
+     *
+     * @param bidId The bid id to search for
+     * @param bid Receives the bid when found
+     * @return True when found
+     */
+    bool Find(std::string_view bidId, BidView& bid) const {
+        if (header == nullptr) {
+            return false;
+        }
+
+        uint64_t mask = header->slotCount - 1;
+        for (uint64_t slot = WyHash(SEED).Bytes(bidId) & mask; slots[slot] != 0; slot = (slot + 1) & mask) {
+            const Record& record = records[slots[slot] - 1];
+            if (text(record.idOffset, record.idLength) == bidId) {
+                bid = At(slots[slot] - 1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * Write bids to a snapshot file, replacing it only once complete
+     *
+     * @param path File to write
+     * @param bids Pointers to objects with bidId, title, fund and
+     *        amount members, in any order
+     * @param sequence Last change log record the bids include
+     * @throws std::runtime_error when the file cannot be written
+     */
+    template <typename BidPointers>
+    static void Write(const std::string& path, BidPointers bids, uint64_t sequence = 0) {
+        std::stable_sort(bids.begin(), bids.end(), [](const auto* a, const auto* b) {
+            return a->bidId < b->bidId;
+        });
+
+        std::vector<Record> recordList;
+        recordList.reserve(bids.size());
+        std::string heapBytes;
+        auto append = [&heapBytes, &path](const std::string& value, uint32_t& offset, uint32_t& size) {
+            if (heapBytes.size() + value.size() > UINT32_MAX) {
+                fail(path, "string heap over 4 GB");
+            }
+            offset = static_cast<uint32_t>(heapBytes.size());
+            size = static_cast<uint32_t>(value.size());
+            heapBytes += value;
+        };
+        for (const auto* bid : bids) {
+            Record record;
+            append(bid->bidId, record.idOffset, record.idLength);
+            append(bid->title, record.titleOffset, record.titleLength);
+            append(bid->fund, record.fundOffset, record.fundLength);
+            record.amount = bid->amount;
+            recordList.push_back(record);
+        }
+
+        // at most half the slots are used, duplicate ids keep the first
+        uint64_t slotCount = 16;
+        while (slotCount < recordList.size() * 2) {
+            slotCount *= 2;
+        }
+        std::vector<uint32_t> slotList(slotCount, 0);
+        for (size_t i = 0; i < recordList.size(); ++i) {
+            uint64_t slot = WyHash(SEED).Bytes(bids[i]->bidId) & (slotCount - 1);
+            while (slotList[slot] != 0) {
+                slot = (slot + 1) & (slotCount - 1);
+            }
+            slotList[slot] = static_cast<uint32_t>(i + 1);
+        }
+
+        // header fields in the order the sections follow it
+        Header fileHeader;
+        std::memset(&fileHeader, 0, sizeof(fileHeader));
+        std::memcpy(fileHeader.magic, MAGIC, sizeof(MAGIC));
+        fileHeader.version = VERSION;
+        fileHeader.endianCheck = ENDIAN_CHECK;
+        fileHeader.sequence = sequence;
+        fileHeader.count = recordList.size();
+        fileHeader.slotCount = slotCount;
+        fileHeader.recordsOffset = sizeof(Header);
+        fileHeader.slotsOffset = fileHeader.recordsOffset + recordList.size() * sizeof(Record);
+        fileHeader.heapOffset = fileHeader.slotsOffset + slotCount * sizeof(uint32_t);
+        fileHeader.fileBytes = fileHeader.heapOffset + heapBytes.size();
+
+        // the file image, with room left for the header
+        std::string image(sizeof(Header), '\0');
+        image.reserve(fileHeader.fileBytes);
+        image.append(reinterpret_cast<const char*>(recordList.data()), recordList.size() * sizeof(Record));
+        image.append(reinterpret_cast<const char*>(slotList.data()), slotList.size() * sizeof(uint32_t));
+        image += heapBytes;
+        std::memcpy(&image[0], &fileHeader, sizeof(Header));
+        fileHeader.checksum = checksum(image.data(), image.size());
+        std::memcpy(&image[0], &fileHeader, sizeof(Header));
+
+        // the new file is on disk before it replaces the old one, so a
+        // change log emptied after a snapshot never loses changes
+        std::string partial = path + ".tmp";
+        if (!writeDurably(partial, image)) {
+            fail(path, "cannot write");
+        }
+#if defined(_WIN32)
+        bool replaced = MoveFileExA(partial.c_str(), path.c_str(),
+            MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+        bool replaced = std::rename(partial.c_str(), path.c_str()) == 0;
+#endif
+        if (!replaced) {
+            fail(path, "cannot replace");
+        }
+#if !defined(_WIN32)
+        // the rename itself is only durable once the directory is synced
+        if (!syncDirectory(path)) {
+            fail(path, "cannot sync directory");
+        }
+#endif
+    }
+};
+
+#endif // MAPPEDBIDS_HPP
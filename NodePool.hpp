@@ -0,0 +1,128 @@
+//============================================================================
+// Name        : NodePool.hpp
+// Author      : Joshua Hale
+// Version     : 1.0
+// Description : Slab allocator for container nodes
+//============================================================================
+
+#ifndef NODEPOOL_HPP
+#define NODEPOOL_HPP
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+// allocator statistics reported by a NodePool
+struct NodePoolStats {
+    size_t blocks = 0;      // blocks allocated
+    size_t liveNodes = 0;   // nodes currently handed out
+    size_t freeNodes = 0;   // destroyed nodes waiting for reuse
+    size_t bytes = 0;       // bytes reserved by all blocks
+    size_t nodeBytes = 0;   // size of one slot, including padding
+};
+
+/**
+ * Hands out nodes from contiguous blocks instead of one heap
+ * allocation per node, so nodes created together sit next to each
+ * other in memory. Destroyed nodes go on a free list and are reused
+ * by the next Create, and every block is released at once when the
+ * pool is destroyed.
+ */
+template <typename T>
+class NodePool {
+
+private:
+    // a slot holds either a live node or a link in the free list
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    std::vector<Slot*> blocks;
+    Slot* freeList = nullptr;
+    size_t slotsPerBlock;
+    size_t nextSlot;  // first never used slot in the newest block
+    NodePoolStats stats;
+
+    Slot* allocateSlot() {
+        if (freeList != nullptr) {
+            Slot* slot = freeList;
+            freeList = slot->next;
+            --stats.freeNodes;
+            return slot;
+        }
+        if (blocks.empty() || nextSlot == slotsPerBlock) {
+            blocks.push_back(static_cast<Slot*>(::operator new(sizeof(Slot) * slotsPerBlock)));
+            nextSlot = 0;
+            ++stats.blocks;
+            stats.bytes += sizeof(Slot) * slotsPerBlock;
+        }
+        return &blocks.back()[nextSlot++];
+    }
+
+public:
+    explicit NodePool(size_t slotsPerBlock = 1024)
+        : slotsPerBlock(slotsPerBlock), nextSlot(slotsPerBlock) {
+        stats.nodeBytes = sizeof(Slot);
+    }
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    /**
+     * Release every block. Nodes still alive are not destructed, the
+     * owning container is expected to have destroyed them already.
+     */
+    ~NodePool() {
+        for (Slot* block : blocks) {
+            ::operator delete(block);
+        }
+    }
+
+    /**
+     * Construct a node in a free slot
+     *
+     * @param args Arguments forwarded to the node constructor
+     * @return The new node
+     */
+    template <typename... Args>
+    T* Create(Args&&... args) {
+        Slot* slot = allocateSlot();
+        T* node;
+        try {
+            node = new (slot->storage) T(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            slot->next = freeList;
+            freeList = slot;
+            ++stats.freeNodes;
+            throw;
+        }
+        ++stats.liveNodes;
+        return node;
+    }
+
+    /**
+     * Destruct a node and put its slot on the free list
+     *
+     * @param node A node returned by Create
+     */
+    void Destroy(T* node) {
+        node->~T();
+        Slot* slot = reinterpret_cast<Slot*>(node);
+        slot->next = freeList;
+        freeList = slot;
+        --stats.liveNodes;
+        ++stats.freeNodes;
+    }
+
+    /**
+     * Current allocator statistics
+     */
+    const NodePoolStats& GetStats() const {
+        return stats;
+    }
+};
+
+#endif // NODEPOOL_HPP
@@ -7,7 +7,18 @@
 //============================================================================
 
 #include <algorithm>  // Include algorithm library for swap function
+#include <atomic>     // Include atomic for the parallel sort's counter
+#include <chrono>     // Include chrono for wall clock timing
+#include <cstdint>    // Include cstdint for fixed width sort keys
+#include <deque>      // Include deque for the parallel sort's work queues
+#include <fstream>    // Include fstream for the external sort's files
+#include <functional> // Include functional for the comparator benchmark
 #include <iostream>   // Include iostream for input and output
+#include <memory>     // Include memory for the external sort's run readers
+#include <mutex>      // Include mutex to guard the work queues
+#include <random>     // Include random to shuffle benchmark input
+#include <stdexcept>  // Include stdexcept for external sort errors
+#include <thread>     // Include thread for the parallel sort
 #include <time.h>     // Include time.h for clock function
 #include "CSVparser.hpp"  // Include CSV parser header
 
@@ -17,6 +28,32 @@ using namespace std;
 // Global definitions visible to all methods and classes
 //============================================================================
 
+// Ranges this small are finished by insertion sort
+const size_t INSERTION_SORT_MAX = 16;
+
+// Ranges larger than this pick a ninther pivot instead of median-of-three
+const size_t NINTHER_MIN = 128;
+
+// Ranges smaller than this are sorted by one thread without splitting
+const size_t PARALLEL_CUTOFF = 4096;
+
+// Number of bids the large input benchmarks sort, the loaded bids
+// repeated as many times as needed
+const size_t BENCHMARK_SIZE = 1000000;
+
+// Default memory budget of the external sort
+const size_t EXTERNAL_SORT_BUDGET = 64 << 20;
+
+// Buffer size for reading the input and writing runs in the external sort
+const size_t IO_BUFFER_BYTES = 1 << 20;
+
+// Smallest read buffer a run gets while merging, however many runs
+const size_t MIN_RUN_BUFFER_BYTES = 64 << 10;
+
+// Largest input the benchmark runs the original quickSort on when it
+// would go quadratic, deeper recursion risks overflowing the stack
+const size_t QUADRATIC_SORT_MAX = 20000;
+
 // Forward declarations
 double strToDouble(string str, char ch);
 
@@ -31,6 +68,65 @@ struct Bid {
     }
 };
 
+//============================================================================
+// Sort order definitions
+//============================================================================
+
+/**
+ * Three-way comparison of two field values: negative, zero or positive
+ */
+template <typename Value>
+int compareValues(const Value& a, const Value& b) {
+    return a < b ? -1 : (b < a ? 1 : 0);
+}
+
+int compareValues(const string& a, const string& b) {
+    return a.compare(b);
+}
+
+// Sort key: a Bid field in ascending order, e.g. Ascending<&Bid::fund>
+template <auto Field>
+struct Ascending {
+    static int compare(const Bid& a, const Bid& b) {
+        return compareValues(a.*Field, b.*Field);
+    }
+};
+
+// Sort key: a Bid field in descending order, e.g. Descending<&Bid::amount>
+template <auto Field>
+struct Descending {
+    static int compare(const Bid& a, const Bid& b) {
+        return compareValues(b.*Field, a.*Field);
+    }
+};
+
+/**
+ * A sort order made of keys compared in turn, each one only breaking
+ * the ties of the keys before it
+ *
+ * The keys are types rather than function objects, so every sort
+ * templated on an order is compiled for it and the comparisons are
+ * inlined into its loops instead of called through a pointer.
+ */
+template <typename... Keys>
+struct SortBy {
+    static int compare(const Bid& a, const Bid& b) {
+        int order = 0;
+        (void)(((order = Keys::compare(a, b)) != 0) || ...);
+        return order;
+    }
+
+    bool operator()(const Bid& a, const Bid& b) const {
+        return compare(a, b) < 0;
+    }
+};
+
+// The sorts' default order
+using ByTitle = SortBy<Ascending<&Bid::title>>;
+
+// Report order: fund, largest amount first, then bid id
+using ByFundAmountId = SortBy<Ascending<&Bid::fund>, Descending<&Bid::amount>, Ascending<&Bid::bidId>>;
+
 //============================================================================
 // Static methods used for testing
 //============================================================================
@@ -115,11 +211,12 @@ vector<Bid> loadBids(string csvPath) {
  * @param begin Beginning index to partition
  * @param end Ending index to partition
  */
+template <typename Order = ByTitle>
 int partition(vector<Bid>& bids, int begin, int end) {
     Bid pivot = bids[end];  // Set pivot as the end element
     int i = begin;
     for (int j = begin; j < end; ++j) {
-        if (bids[j].title <= pivot.title) {  // Compare title with pivot
+        if (Order::compare(bids[j], pivot) <= 0) {  // Compare with pivot
             swap(bids[i], bids[j]);
             i++;
         }
@@ -129,7 +226,7 @@ int partition(vector<Bid>& bids, int begin, int end) {
 }
 
 /**
- * Perform a quick sort on bid title
+ * Perform a quick sort on bid title, or on the keys of Order
  * Average performance: O(n log(n))
  * Worst case performance O(n^2))
  *
@@ -137,27 +234,938 @@ int partition(vector<Bid>& bids, int begin, int end) {
  * @param begin The beginning index to sort on
  * @param end The ending index to sort on
  */
+template <typename Order = ByTitle>
 void quickSort(vector<Bid>& bids, int begin, int end) {
     if (begin >= end) {
         return;  // Base case: If the range is 1 or zero elements
     }
-    int partitionIndex = partition(bids, begin, end);  // Partition the bids
-    quickSort(bids, begin, partitionIndex - 1);  // Recursively sort the left partition
-    quickSort(bids, partitionIndex + 1, end);    // Recursively sort the right partition
+    int partitionIndex = partition<Order>(bids, begin, end);  // Partition the bids
+    quickSort<Order>(bids, begin, partitionIndex - 1);  // Recursively sort the left partition
+    quickSort<Order>(bids, partitionIndex + 1, end);    // Recursively sort the right partition
+}
+
+/**
+ * Perform an insertion sort on bid title over a small range
+ *
+ * @param bids Address of the vector<Bid> instance to be sorted
+ * @param begin First index of the range
+ * @param end One past the last index of the range
+ */
+template <typename Order = ByTitle>
+void insertionSort(vector<Bid>& bids, size_t begin, size_t end) {
+    for (size_t i = begin + 1; i < end; ++i) {
+        // Shift larger bids right until the bid's slot opens up
+        Bid bid = move(bids[i]);
+        size_t j = i;
+        while (j > begin && Order::compare(bid, bids[j - 1]) < 0) {
+            bids[j] = move(bids[j - 1]);
+            --j;
+        }
+        bids[j] = move(bid);
+    }
+}
+
+/**
+ * Perform a heap sort on bid title over a range
+ * Worst case performance O(n log(n))
+ *
+ * @param bids Address of the vector<Bid> instance to be sorted
+ * @param begin First index of the range
+ * @param end One past the last index of the range
+ */
+template <typename Order = ByTitle>
+void heapSort(vector<Bid>& bids, size_t begin, size_t end) {
+    make_heap(bids.begin() + begin, bids.begin() + end, Order());
+    sort_heap(bids.begin() + begin, bids.begin() + end, Order());
 }
 
 /**
- * Perform a selection sort on bid title
+ * Index of the median bid of three
+ */
+template <typename Order = ByTitle>
+size_t medianOfThree(const vector<Bid>& bids, size_t a, size_t b, size_t c) {
+    Order less;
+    const Bid& x = bids[a];
+    const Bid& y = bids[b];
+    const Bid& z = bids[c];
+    if (less(x, y)) {
+        return less(y, z) ? b : (less(x, z) ? c : a);
+    }
+    return less(x, z) ? a : (less(y, z) ? c : b);
+}
+
+/**
+ * Index of a pivot for a range: the median of three, or for large
+ * ranges the median of three medians of three (ninther)
+ */
+template <typename Order = ByTitle>
+size_t choosePivot(const vector<Bid>& bids, size_t begin, size_t end) {
+    size_t size = end - begin;
+    size_t middle = begin + size / 2;
+    size_t last = end - 1;
+    if (size > NINTHER_MIN) {
+        size_t step = size / 8;
+        return medianOfThree<Order>(bids,
+            medianOfThree<Order>(bids, begin, begin + step, begin + 2 * step),
+            medianOfThree<Order>(bids, middle - step, middle, middle + step),
+            medianOfThree<Order>(bids, last - 2 * step, last - step, last));
+    }
+    return medianOfThree<Order>(bids, begin, middle, last);
+}
+
+/**
+ * Partitioning rounds introsort allows before falling back to heap
+ * sort, twice the depth of a perfectly balanced split
+ */
+int depthLimitFor(size_t size) {
+    int depthLimit = 0;
+    for (; size > 1; size /= 2) {
+        depthLimit += 2;
+    }
+    return depthLimit;
+}
+
+/**
+ * Partition a range into titles less than, equal to and greater than
+ * a pivot (Bentley-McIlroy), or bids by the keys of Order
+ *
+ * Equal titles are swapped to both ends while scanning and moved to
+ * the middle at the end, so a range of equal titles is finished in a
+ * single pass instead of going quadratic.
+ *
+ * @param bids Address of the vector<Bid> instance to be partitioned
+ * @param begin First index of the range, holding the pivot
+ * @param end One past the last index of the range
+ * @param lessEnd Receives one past the last title less than the pivot
+ * @param greaterBegin Receives the first title greater than the pivot
+ */
+template <typename Order = ByTitle>
+void partitionThreeWay(vector<Bid>& bids, size_t begin, size_t end, size_t& lessEnd, size_t& greaterBegin) {
+    const Bid& pivot = bids[begin];  // Stays at begin until the end
+
+    // [begin, a) equal, [a, b) less, (c, d] greater, (d, end) equal
+    size_t a = begin + 1, b = begin + 1;
+    size_t c = end - 1, d = end - 1;
+    while (true) {
+        int order;
+        while (b <= c && (order = Order::compare(bids[b], pivot)) <= 0) {
+            if (order == 0) {
+                swap(bids[a++], bids[b]);
+            }
+            ++b;
+        }
+        while (c >= b && (order = Order::compare(bids[c], pivot)) >= 0) {
+            if (order == 0) {
+                swap(bids[c], bids[d--]);
+            }
+            --c;
+        }
+        if (b > c) {
+            break;
+        }
+        swap(bids[b++], bids[c--]);
+    }
+
+    // Move the equal titles from both ends into the middle
+    size_t count = min(a - begin, b - a);
+    swap_ranges(bids.begin() + begin, bids.begin() + begin + count, bids.begin() + b - count);
+    count = min(d - c, end - 1 - d);
+    swap_ranges(bids.begin() + b, bids.begin() + b + count, bids.begin() + end - count);
+
+    lessEnd = begin + (b - a);
+    greaterBegin = end - (d - c);
+}
+
+/**
+ * Sort a range by introsort, switching to heap sort once the depth
+ * limit shows the pivots are going badly
+ *
+ * Only the smaller side is recursed into and the larger one is looped
+ * on, so the stack stays O(log(n)) deep.
+ *
+ * @param bids Address of the vector<Bid> instance to be sorted
+ * @param begin First index of the range
+ * @param end One past the last index of the range
+ * @param depthLimit Partitioning rounds left before heap sort
+ */
+template <typename Order = ByTitle>
+void introSortRange(vector<Bid>& bids, size_t begin, size_t end, int depthLimit) {
+    while (end - begin > INSERTION_SORT_MAX) {
+        if (depthLimit-- == 0) {
+            heapSort<Order>(bids, begin, end);
+            return;
+        }
+
+        swap(bids[begin], bids[choosePivot<Order>(bids, begin, end)]);
+
+        size_t lessEnd, greaterBegin;
+        partitionThreeWay<Order>(bids, begin, end, lessEnd, greaterBegin);
+
+        if (lessEnd - begin < end - greaterBegin) {
+            introSortRange<Order>(bids, begin, lessEnd, depthLimit);
+            begin = greaterBegin;
+        }
+        else {
+            introSortRange<Order>(bids, greaterBegin, end, depthLimit);
+            end = lessEnd;
+        }
+    }
+    insertionSort<Order>(bids, begin, end);
+}
+
+/**
+ * Perform an introsort on bid title, or on the keys of Order, e.g.
+ * introSort<ByFundAmountId>(bids)
+ * Average performance: O(n log(n))
+ * Worst case performance O(n log(n))
+ *
+ * @param bids Address of the vector<Bid> instance to be sorted
+ */
+template <typename Order = ByTitle>
+void introSort(vector<Bid>& bids) {
+    introSortRange<Order>(bids, 0, bids.size(), depthLimitFor(bids.size()));
+}
+
+/**
+ * Character of a title at a depth for multikey quicksort, as unsigned
+ * so the order matches string comparison, or -1 past the end
+ */
+int charAt(const string& title, size_t depth) {
+    return depth < title.size() ? (unsigned char)title[depth] : -1;
+}
+
+/**
+ * Perform an insertion sort on bid title over a small range whose
+ * titles all share their first depth characters
+ *
+ * Alongside the sorted part it keeps the longest common prefix (LCP)
+ * of each pair of neighbours. Comparing a bid against the one before
+ * its slot then starts after the prefix they are known to share, and
+ * is skipped entirely when the LCPs alone decide the order.
+ *
+ * @param bids Address of the vector<Bid> instance to be sorted
+ * @param begin First index of the range
+ * @param end One past the last index of the range
+ * @param depth Length of the prefix every title in the range shares
+ */
+void lcpInsertionSort(vector<Bid>& bids, size_t begin, size_t end, size_t depth) {
+    // lcp[k] is the LCP of the titles at begin + k - 1 and begin + k
+    size_t lcp[INSERTION_SORT_MAX + 1];
+
+    for (size_t j = begin + 1; j < end; ++j) {
+        Bid bid = move(bids[j]);
+        const string& title = bid.title;
+        size_t i = j;
+        size_t after = depth;   // LCP with the bid after the slot, once i < j
+        size_t before = depth;  // LCP with the bid before the slot
+        while (i > begin) {
+            const string& previous = bids[i - 1].title;
+            size_t shared = after;
+            if (i < j && lcp[i - begin] < after) {
+                // The previous title leaves the next one earlier, so it
+                // is smaller than this one too
+                before = lcp[i - begin];
+                break;
+            }
+            if (i == j || lcp[i - begin] == after) {
+                while (shared < title.size() && shared < previous.size() && title[shared] == previous[shared]) {
+                    ++shared;
+                }
+                if (charAt(previous, shared) <= charAt(title, shared)) {
+                    before = shared;
+                    break;
+                }
+            }
+
+            // This title is smaller, shift the previous bid up
+            bids[i] = move(bids[i - 1]);
+            if (i < j) {
+                lcp[i + 1 - begin] = lcp[i - begin];
+            }
+            after = shared;
+            --i;
+        }
+
+        bids[i] = move(bid);
+        if (i > begin) {
+            lcp[i - begin] = before;
+        }
+        if (i < j) {
+            lcp[i + 1 - begin] = after;
+        }
+    }
+}
+
+/**
+ * Sort a range by multikey quicksort on the characters of the titles
+ * from a depth on
+ *
+ * Partitions three ways on one character: titles with a smaller or
+ * larger character there are sorted again at the same depth, titles
+ * with the same character move on to the next one. Every character
+ * is looked at a bounded number of times, so the work is close to the
+ * number of characters that tell the titles apart rather than
+ * n log(n) full string compares over long shared prefixes.
+ *
+ * @param bids Address of the vector<Bid> instance to be sorted
+ * @param begin First index of the range
+ * @param end One past the last index of the range
+ * @param depth Length of the prefix every title in the range shares
+ */
+void multikeyRange(vector<Bid>& bids, size_t begin, size_t end, size_t depth) {
+    while (end - begin > INSERTION_SORT_MAX) {
+        // Median-of-three pivot character
+        int first = charAt(bids[begin].title, depth);
+        int middle = charAt(bids[begin + (end - begin) / 2].title, depth);
+        int last = charAt(bids[end - 1].title, depth);
+        int pivot = max(min(first, middle), min(max(first, middle), last));
+
+        // [begin, lt) smaller, [lt, i) equal, [gt, end) larger
+        size_t lt = begin, i = begin, gt = end;
+        while (i < gt) {
+            int ch = charAt(bids[i].title, depth);
+            if (ch < pivot) {
+                swap(bids[lt++], bids[i++]);
+            }
+            else if (ch > pivot) {
+                swap(bids[i], bids[--gt]);
+            }
+            else {
+                ++i;
+            }
+        }
+
+        // Titles that ended at this depth are equal and finished
+        struct Part { size_t begin, end, depth; };
+        Part parts[3] = { { begin, lt, depth }, { lt, pivot < 0 ? lt : gt, depth + 1 }, { gt, end, depth } };
+
+        // Loop on the largest part, so the stack stays shallow
+        Part* largest = &parts[0];
+        for (Part& part : parts) {
+            if (part.end - part.begin > largest->end - largest->begin) {
+                largest = &part;
+            }
+        }
+        for (Part& part : parts) {
+            if (&part != largest) {
+                multikeyRange(bids, part.begin, part.end, part.depth);
+            }
+        }
+        begin = largest->begin;
+        end = largest->end;
+        depth = largest->depth;
+    }
+    lcpInsertionSort(bids, begin, end, depth);
+}
+
+/**
+ * Perform a multikey quicksort on bid title
+ * Average performance: O(n log(n) + D) character compares, where D is
+ * the number of characters needed to tell the titles apart
+ *
+ * @param bids Address of the vector<Bid> instance to be sorted
+ */
+void multikeyQuickSort(vector<Bid>& bids) {
+    multikeyRange(bids, 0, bids.size(), 0);
+}
+
+// A bid's place in an indirect sort: 8 bytes of its title packed
+// big-endian, so comparing prefixes as integers orders them like the
+// titles, and the index of the bid
+struct TitleKey {
+    uint64_t prefix;
+    size_t index;
+};
+
+/**
+ * 8 bytes of a title from an offset as an integer, zero padded past
+ * the end
+ */
+uint64_t titlePrefix(const string& title, size_t offset) {
+    uint64_t prefix = 0;
+    for (size_t i = offset; i < offset + 8; ++i) {
+        prefix = (prefix << 8) | (i < title.size() ? (unsigned char)title[i] : 0);
+    }
+    return prefix;
+}
+
+/**
+ * Sort keys on their prefixes, then sort each run of tied keys on the
+ * next 8 bytes of their titles, until the titles run out
+ *
+ * @param bids The bids the keys index
+ * @param keys Keys holding the title bytes from offset
+ * @param begin First key of the range
+ * @param end One past the last key of the range
+ * @param offset Title offset the prefixes were taken from
+ */
+void sortKeys(const vector<Bid>& bids, vector<TitleKey>& keys, size_t begin, size_t end, size_t offset) {
+    sort(keys.begin() + begin, keys.begin() + end, [](const TitleKey& a, const TitleKey& b) {
+        return a.prefix < b.prefix;
+    });
+
+    for (size_t run = begin; run < end;) {
+        size_t size = bids[keys[run].index].title.size();
+        size_t runEnd = run + 1;
+        bool longer = size > offset + 8;
+        bool sameSize = true;
+        while (runEnd < end && keys[runEnd].prefix == keys[run].prefix) {
+            size_t next = bids[keys[runEnd].index].title.size();
+            longer = longer || next > offset + 8;
+            sameSize = sameSize && next == size;
+            ++runEnd;
+        }
+
+        if (runEnd - run > 1 && longer) {
+            // Tied titles with bytes left, compare the next 8
+            for (size_t i = run; i < runEnd; ++i) {
+                keys[i].prefix = titlePrefix(bids[keys[i].index].title, offset + 8);
+            }
+            sortKeys(bids, keys, run, runEnd, offset + 8);
+        }
+        else if (!sameSize) {
+            // Titles that only differ in trailing zero bytes, which
+            // pad like the end of a shorter title
+            sort(keys.begin() + run, keys.begin() + runEnd, [&bids](const TitleKey& a, const TitleKey& b) {
+                return bids[a.index].title.size() < bids[b.index].title.size();
+            });
+        }
+        run = runEnd;
+    }
+}
+
+/**
+ * Work out the title order of the bids without moving them
+ *
+ * Sorts a compact array of title prefixes and indexes, 16 bytes per
+ * bid, instead of swapping whole bids, comparing integers only. Titles
+ * are only read again to break ties between prefixes.
+ *
+ * @param bids The bids to order
+ * @return One key per bid in title order, its index says which bid
+ */
+vector<TitleKey> sortedView(const vector<Bid>& bids) {
+    vector<TitleKey> keys(bids.size());
+    for (size_t i = 0; i < bids.size(); ++i) {
+        keys[i].prefix = titlePrefix(bids[i].title, 0);
+        keys[i].index = i;
+    }
+    sortKeys(bids, keys, 0, keys.size(), 0);
+    return keys;
+}
+
+/**
+ * Move the bids into the order of a view, moving each bid once by
+ * following the cycles of the permutation
+ *
+ * @param bids Address of the vector<Bid> instance to be reordered
+ * @param view Order returned by sortedView for these bids
+ */
+void applyView(vector<Bid>& bids, const vector<TitleKey>& view) {
+    // source[i] is the index of the bid that belongs at i, or i once
+    // it is there
+    vector<size_t> source(view.size());
+    for (size_t i = 0; i < view.size(); ++i) {
+        source[i] = view[i].index;
+    }
+
+    for (size_t start = 0; start < source.size(); ++start) {
+        if (source[start] == start) {
+            continue;
+        }
+        Bid bid = move(bids[start]);
+        size_t hole = start;
+        while (source[hole] != start) {
+            size_t next = source[hole];
+            bids[hole] = move(bids[next]);
+            source[hole] = hole;
+            hole = next;
+        }
+        bids[hole] = move(bid);
+        source[hole] = hole;
+    }
+}
+
+/**
+ * Perform an indirect sort on bid title, sorting title prefixes and
+ * indexes and then moving every bid once
+ * Average performance: O(n log(n))
+ *
+ * @param bids Address of the vector<Bid> instance to be sorted
+ */
+void indirectSort(vector<Bid>& bids) {
+    applyView(bids, sortedView(bids));
+}
+
+//============================================================================
+// Parallel sort class definition
+//============================================================================
+
+/**
+ * Define a class that sorts bids by title on several threads
+ *
+ * Every thread keeps a deque of ranges still to sort. It splits a
+ * range with the same three-way partition as introSort, queues the
+ * smaller side and carries on with the larger one, and sorts ranges
+ * below PARALLEL_CUTOFF on its own with introSortRange. A thread whose
+ * deque runs dry steals the oldest, usually largest, range from the
+ * front of another thread's deque. The sort is done once every bid is
+ * in its final place.
+ */
+template <typename Order = ByTitle>
+class ParallelSorter {
+
+private:
+    // A range still to sort
+    struct Range {
+        size_t begin;
+        size_t end;
+        int depthLimit;
+    };
+
+    // One thread's ranges, on a cache line of its own
+    struct alignas(64) Worker {
+        mutex lock;
+        deque<Range> ranges;
+    };
+
+    vector<Bid>& bids;
+    vector<Worker> workers;
+    atomic<size_t> unsorted;  // Bids not yet in their final place
+
+    ParallelSorter(vector<Bid>& aBids, unsigned int threads) : bids(aBids), workers(threads) {
+        unsorted = bids.size();
+    }
+
+    bool take(size_t self, Range& range);
+    void sortRange(size_t self, Range range);
+    void work(size_t self);
+
+public:
+    static void Sort(vector<Bid>& bids, unsigned int threads);
+};
+
+/**
+ * Take the newest range of a thread's own deque, or steal the oldest
+ * range of another thread's
+ *
+ * @return False when every deque is empty
+ */
+template <typename Order>
+bool ParallelSorter<Order>::take(size_t self, Range& range) {
+    for (size_t i = 0; i < workers.size(); ++i) {
+        Worker& worker = workers[(self + i) % workers.size()];
+        lock_guard<mutex> guard(worker.lock);
+        if (!worker.ranges.empty()) {
+            if (i == 0) {
+                range = worker.ranges.back();
+                worker.ranges.pop_back();
+            }
+            else {
+                range = worker.ranges.front();
+                worker.ranges.pop_front();
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Split a range until it is small enough, queueing one side of every
+ * split, then sort what is left
+ */
+template <typename Order>
+void ParallelSorter<Order>::sortRange(size_t self, Range range) {
+    while (range.end - range.begin > PARALLEL_CUTOFF && range.depthLimit > 0) {
+        --range.depthLimit;
+        swap(bids[range.begin], bids[choosePivot<Order>(bids, range.begin, range.end)]);
+
+        size_t lessEnd, greaterBegin;
+        partitionThreeWay<Order>(bids, range.begin, range.end, lessEnd, greaterBegin);
+        unsorted -= greaterBegin - lessEnd;  // Equal titles are in place
+
+        Range less = { range.begin, lessEnd, range.depthLimit };
+        Range greater = { greaterBegin, range.end, range.depthLimit };
+        bool lessIsSmaller = lessEnd - range.begin < range.end - greaterBegin;
+        {
+            lock_guard<mutex> guard(workers[self].lock);
+            workers[self].ranges.push_back(lessIsSmaller ? less : greater);
+        }
+        range = lessIsSmaller ? greater : less;
+    }
+
+    // Falls back to heap sort when the depth limit ran out
+    introSortRange<Order>(bids, range.begin, range.end, range.depthLimit);
+    unsorted -= range.end - range.begin;
+}
+
+/**
+ * Sort ranges until every bid is in place
+ */
+template <typename Order>
+void ParallelSorter<Order>::work(size_t self) {
+    Range range;
+    while (unsorted > 0) {
+        if (take(self, range)) {
+            sortRange(self, range);
+        }
+        else {
+            this_thread::yield();
+        }
+    }
+}
+
+/**
+ * Sort bids by Order, the calling thread works alongside the others
+ *
+ * @param bids Address of the vector<Bid> instance to be sorted
+ * @param threads Number of threads to sort with
+ */
+template <typename Order>
+void ParallelSorter<Order>::Sort(vector<Bid>& bids, unsigned int threads) {
+    ParallelSorter sorter(bids, max(threads, 1u));
+    sorter.workers[0].ranges.push_back({ 0, bids.size(), depthLimitFor(bids.size()) });
+
+    vector<thread> helpers;
+    for (size_t i = 1; i < sorter.workers.size(); ++i) {
+        helpers.emplace_back(&ParallelSorter<Order>::work, &sorter, i);
+    }
+    sorter.work(0);
+    for (thread& helper : helpers) {
+        helper.join();
+    }
+}
+
+/**
+ * Perform a parallel intro sort on bid title, or on the keys of Order
+ * Average performance: O(n log(n) / threads)
+ * Worst case performance O(n log(n))
+ *
+ * @param bids Address of the vector<Bid> instance to be sorted
+ * @param threads Number of threads to sort with
+ */
+template <typename Order = ByTitle>
+void parallelSort(vector<Bid>& bids, unsigned int threads) {
+    ParallelSorter<Order>::Sort(bids, threads);
+}
+
+//============================================================================
+// External sort class definitions
+//============================================================================
+
+// A CSV row in an external sort: the title it sorts on and the whole
+// line, so every column reaches the output
+struct SortRecord {
+    string title;
+    string line;
+};
+
+// External sort statistics
+struct ExternalSortStats {
+    size_t rows = 0;
+    size_t runs = 0;
+    unsigned long long bytes = 0;  // Size of the input file
+    double runSeconds = 0.0;       // Reading, sorting and writing runs
+    double mergeSeconds = 0.0;     // Merging the runs into the output
+};
+
+/**
+ * Title column of a CSV line, the first one, without its quotes
+ */
+string csvTitle(const string& line) {
+    if (line.empty() || line[0] != '"') {
+        return line.substr(0, line.find(','));
+    }
+
+    string title;
+    for (size_t i = 1; i < line.size(); ++i) {
+        if (line[i] != '"') {
+            title += line[i];
+        }
+        else if (i + 1 < line.size() && line[i + 1] == '"') {
+            title += '"';  // Doubled quote inside a quoted field
+            ++i;
+        }
+        else {
+            break;
+        }
+    }
+    return title;
+}
+
+/**
+ * Write a length-prefixed string to a run file
+ */
+void writeString(ostream& out, const string& value) {
+    uint32_t size = (uint32_t)value.size();
+    out.write((const char*)&size, sizeof(size));
+    out.write(value.data(), size);
+}
+
+/**
+ * Read a length-prefixed string from a run file
+ *
+ * @return False at the end of the file
+ */
+bool readString(istream& in, string& value) {
+    uint32_t size;
+    if (!in.read((char*)&size, sizeof(size))) {
+        return false;
+    }
+    value.resize(size);
+    return size == 0 || (bool)in.read(&value[0], size);
+}
+
+/**
+ * Define a class that reads a sorted run file back one record at a
+ * time through a buffer of its own
+ */
+class RunReader {
+
+private:
+    string path;
+    vector<char> buffer;  // Declared first so it outlives the stream
+    ifstream in;
+
+public:
+    SortRecord record;  // Current record, valid until done
+    bool done;
+
+    /**
+     * @throws runtime_error when the run cannot be opened
+     */
+    RunReader(const string& aPath, size_t bufferBytes) : path(aPath), buffer(bufferBytes) {
+        in.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+        in.open(path, ios::binary);
+        if (!in) {
+            throw runtime_error("cannot open " + path);
+        }
+        done = false;
+        Next();
+    }
+
+    /**
+     * @throws runtime_error when the run cannot be read or is cut short
+     */
+    void Next() {
+        if (in.peek() == EOF) {
+            if (in.bad()) {
+                throw runtime_error("cannot read " + path);
+            }
+            done = true;
+            return;
+        }
+        if (!readString(in, record.title) || !readString(in, record.line)) {
+            throw runtime_error("cannot read " + path);
+        }
+    }
+};
+
+// Run files of an external sort, removed however the sort ends
+struct RunFiles {
+    vector<string> paths;
+
+    ~RunFiles() {
+        for (const string& path : paths) {
+            remove(path.c_str());
+        }
+    }
+};
+
+/**
+ * Define a class that merges sorted runs with a tournament tree of
+ * losers
+ *
+ * Each internal node keeps the run that lost the match played there,
+ * node 0 keeps the overall winner. Taking the winner's next record only
+ * replays the matches on the path from its leaf to the root, so each
+ * record costs log2(k) comparisons against k runs, one per level, and
+ * never looks at the siblings a heap would. Ties go to the earlier
+ * run, which keeps the merge stable.
+ */
+class LoserTree {
+
+private:
+    vector<unique_ptr<RunReader>>& runs;
+    vector<size_t> tree;
+
+    // True when run a's record comes first, finished runs come last
+    bool less(size_t a, size_t b) const {
+        if (runs[a]->done || runs[b]->done) {
+            return !runs[a]->done;
+        }
+        int order = runs[a]->record.title.compare(runs[b]->record.title);
+        return order < 0 || (order == 0 && a < b);
+    }
+
+public:
+    /**
+     * Play every match once, bottom up
+     *
+     * @param aRuns The runs to merge, at least one
+     */
+    LoserTree(vector<unique_ptr<RunReader>>& aRuns) : runs(aRuns), tree(aRuns.size()) {
+        // Winners of each subtree, leaf i sits at node k + i
+        size_t k = runs.size();
+        vector<size_t> winners(2 * k);
+        for (size_t i = 0; i < k; ++i) {
+            winners[k + i] = i;
+        }
+        for (size_t node = k - 1; node >= 1; --node) {
+            size_t a = winners[2 * node];
+            size_t b = winners[2 * node + 1];
+            winners[node] = less(a, b) ? a : b;
+            tree[node] = less(a, b) ? b : a;
+        }
+        tree[0] = winners[1 % (2 * k)];
+    }
+
+    bool Empty() const {
+        return runs[tree[0]]->done;
+    }
+
+    const SortRecord& Top() const {
+        return runs[tree[0]]->record;
+    }
+
+    /**
+     * Move the winning run to its next record and replay its path
+     */
+    void Advance() {
+        size_t winner = tree[0];
+        runs[winner]->Next();
+        for (size_t node = (runs.size() + winner) / 2; node >= 1; node /= 2) {
+            if (less(tree[node], winner)) {
+                swap(tree[node], winner);
+            }
+        }
+        tree[0] = winner;
+    }
+};
+
+/**
+ * Sort a bid CSV file by title without holding it in memory
+ *
+ * Rows are read until they fill the memory budget, sorted and written
+ * to a temporary run file, then all runs are merged in one pass with a
+ * loser tree, splitting the budget between the runs' read buffers. The
+ * header row stays first and every row is copied unchanged.
+ *
+ * @param inputPath CSV file to sort
+ * @param outputPath Sorted CSV file to write, run files go next to it
+ * @param memoryBudget Bytes of rows to hold at once
+ * @return Row, run and timing statistics
+ * @throws runtime_error when a file cannot be read or written
+ */
+ExternalSortStats externalSort(const string& inputPath, const string& outputPath, size_t memoryBudget) {
+    ExternalSortStats stats;
+    auto start = chrono::steady_clock::now();
+
+    vector<char> inBuffer(IO_BUFFER_BYTES);
+    ifstream in;
+    in.rdbuf()->pubsetbuf(inBuffer.data(), inBuffer.size());
+    in.open(inputPath, ios::binary);
+    if (!in) {
+        throw runtime_error("cannot open " + inputPath);
+    }
+    string header;
+    getline(in, header);
+    stats.bytes = header.size() + 1;
+
+    // Form sorted runs that each fit the budget, declared before the
+    // readers so they are closed before the files are removed
+    RunFiles runFiles;
+    vector<string>& runPaths = runFiles.paths;
+    vector<SortRecord> records;
+    size_t used = 0;
+    auto writeRun = [&]() {
+        stable_sort(records.begin(), records.end(), [](const SortRecord& a, const SortRecord& b) {
+            return a.title < b.title;
+        });
+
+        string path = outputPath + ".run" + to_string(runPaths.size());
+        runPaths.push_back(path);
+        vector<char> outBuffer(IO_BUFFER_BYTES);
+        ofstream out;
+        out.rdbuf()->pubsetbuf(outBuffer.data(), outBuffer.size());
+        out.open(path, ios::binary | ios::trunc);
+        for (const SortRecord& record : records) {
+            writeString(out, record.title);
+            writeString(out, record.line);
+        }
+        out.close();
+        if (!out) {
+            throw runtime_error("cannot write " + path);
+        }
+        records.clear();
+        used = 0;
+    };
+
+    string line;
+    while (getline(in, line)) {
+        stats.bytes += line.size() + 1;
+        if (line.empty()) {
+            continue;
+        }
+        SortRecord record;
+        record.title = csvTitle(line);
+        record.line = move(line);
+        used += sizeof(SortRecord) + record.title.size() + record.line.size();
+        records.push_back(move(record));
+        ++stats.rows;
+        if (used >= memoryBudget) {
+            writeRun();
+        }
+    }
+    if (!records.empty()) {
+        writeRun();
+    }
+    records.shrink_to_fit();
+    stats.runs = runPaths.size();
+    auto merged = chrono::steady_clock::now();
+    stats.runSeconds = chrono::duration<double>(merged - start).count();
+
+    // Merge every run into the output
+    size_t bufferBytes = max(memoryBudget / (runPaths.size() + 1), MIN_RUN_BUFFER_BYTES);
+    vector<unique_ptr<RunReader>> runs;
+    for (const string& path : runPaths) {
+        runs.push_back(unique_ptr<RunReader>(new RunReader(path, bufferBytes)));
+    }
+
+    vector<char> outBuffer(bufferBytes);
+    ofstream out;
+    out.rdbuf()->pubsetbuf(outBuffer.data(), outBuffer.size());
+    out.open(outputPath, ios::binary | ios::trunc);
+    out << header << '\n';
+    if (!runs.empty()) {
+        LoserTree tree(runs);
+        while (!tree.Empty()) {
+            out << tree.Top().line << '\n';
+            tree.Advance();
+        }
+    }
+    out.close();
+    if (!out) {
+        throw runtime_error("cannot write " + outputPath);
+    }
+    stats.mergeSeconds = chrono::duration<double>(chrono::steady_clock::now() - merged).count();
+    return stats;
+}
+
+/**
+ * Perform a selection sort on bid title, or on the keys of Order
  * Average performance: O(n^2))
  * Worst case performance O(n^2))
  *
  * @param bid Address of the vector<Bid> instance to be sorted
  */
+template <typename Order = ByTitle>
 void selectionSort(vector<Bid>& bids) {
     for (size_t i = 0; i < bids.size(); ++i) {  // Change 'int' to 'size_t' for correct type comparison
         size_t minIndex = i;
         for (size_t j = i + 1; j < bids.size(); ++j) {  // Change 'int' to 'size_t' for correct type comparison
-            if (bids[j].title < bids[minIndex].title) {
+            if (Order::compare(bids[j], bids[minIndex]) < 0) {
                 minIndex = j;
             }
         }
@@ -180,6 +1188,261 @@ double strToDouble(string str, char ch) {
     return atof(str.c_str());
 }
 
+/**
+ * Time one sort on a copy of the bids and check the result is in Order
+ *
+ * @param name Label printed for the sort
+ * @param bids The bids to copy and sort
+ * @param sort Called with the copy to sort it
+ */
+template <typename Order = ByTitle, typename Sort>
+void timeSort(const string& name, const vector<Bid>& bids, Sort sort) {
+    vector<Bid> copy = bids;
+    clock_t ticks = clock();
+    sort(copy);
+    ticks = clock() - ticks;
+
+    bool sorted = is_sorted(copy.begin(), copy.end(), Order());
+    cout << "  " << name << ": " << (double)ticks / CLOCKS_PER_SEC << " seconds"
+        << (sorted ? "" : " (NOT SORTED)") << endl;
+}
+
+/**
+ * Compare quickSort, introSort, multikeyQuickSort and std::sort on the
+ * loaded bids as read, already sorted, reversed and with every title
+ * equal
+ *
+ * @param bids The loaded bids
+ */
+void benchmarkSorts(const vector<Bid>& bids) {
+    auto byTitle = [](const Bid& a, const Bid& b) { return a.title < b.title; };
+
+    vector<Bid> sorted = bids;
+    stable_sort(sorted.begin(), sorted.end(), byTitle);
+    vector<Bid> reversed(sorted.rbegin(), sorted.rend());
+    vector<Bid> equal = bids;
+    for (Bid& bid : equal) {
+        bid.title = "Misc. items";
+    }
+
+    const vector<Bid>* inputs[] = { &bids, &sorted, &reversed, &equal };
+    const char* names[] = { "as loaded", "sorted", "reversed", "equal titles" };
+    for (int i = 0; i < 4; ++i) {
+        const vector<Bid>& input = *inputs[i];
+        cout << names[i] << " (" << input.size() << " bids):" << endl;
+
+        // The Lomuto partition goes quadratic on every input but the first
+        if (i == 0 || input.size() <= QUADRATIC_SORT_MAX) {
+            timeSort("quickSort", input, [](vector<Bid>& v) {
+                quickSort(v, 0, (int)v.size() - 1);
+            });
+        }
+        else {
+            cout << "  quickSort: skipped, too deep a recursion" << endl;
+        }
+        timeSort("introSort", input, [](vector<Bid>& v) {
+            introSort(v);
+        });
+        timeSort("multikeyQuickSort", input, [](vector<Bid>& v) {
+            multikeyQuickSort(v);
+        });
+        timeSort("std::sort", input, [byTitle](vector<Bid>& v) {
+            sort(v.begin(), v.end(), byTitle);
+        });
+    }
+}
+
+/**
+ * Repeat bids up to a count and shuffle them, as benchmark input
+ *
+ * @param bids The bids to repeat, not empty
+ * @param count Number of bids to return
+ */
+vector<Bid> repeatBids(const vector<Bid>& bids, size_t count) {
+    vector<Bid> input;
+    input.reserve(count);
+    while (input.size() < count) {
+        input.push_back(bids[input.size() % bids.size()]);
+    }
+    mt19937 rng(2024);
+    shuffle(input.begin(), input.end(), rng);
+    return input;
+}
+
+/**
+ * Time the parallel sort with more and more threads against introSort
+ * on one thread, reporting the speedup of each thread count
+ *
+ * @param bids The loaded bids, repeated up to BENCHMARK_SIZE
+ */
+void benchmarkParallelSort(const vector<Bid>& bids) {
+    if (bids.empty()) {
+        cout << "Load bids first" << endl;
+        return;
+    }
+    vector<Bid> input = repeatBids(bids, BENCHMARK_SIZE);
+
+    // Wall clock time, clock() adds up the time of every thread
+    auto timeRun = [&input](unsigned int threads) {
+        vector<Bid> copy = input;
+        auto start = chrono::steady_clock::now();
+        if (threads == 0) {
+            introSort(copy);
+        }
+        else {
+            parallelSort(copy, threads);
+        }
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+
+    double baseline = timeRun(0);
+    cout << input.size() << " bids, introSort: " << baseline << " seconds" << endl;
+
+    unsigned int cores = max(thread::hardware_concurrency(), 1u);
+    for (unsigned int threads = 1; threads <= max(cores, 8u); threads *= 2) {
+        double seconds = timeRun(threads);
+        cout << "  " << threads << " threads: " << seconds << " seconds, speedup "
+            << baseline / seconds << "x" << (threads > cores ? " (more threads than cores)" : "") << endl;
+    }
+}
+
+/**
+ * Compare introSort, which swaps whole bids, with the indirect sort's
+ * view alone and with the view applied to the bids
+ *
+ * @param bids The loaded bids, repeated up to BENCHMARK_SIZE
+ */
+void benchmarkIndirectSort(const vector<Bid>& bids) {
+    if (bids.empty()) {
+        cout << "Load bids first" << endl;
+        return;
+    }
+    vector<Bid> input = repeatBids(bids, BENCHMARK_SIZE);
+    cout << input.size() << " bids:" << endl;
+
+    timeSort("introSort", input, [](vector<Bid>& v) {
+        introSort(v);
+    });
+
+    clock_t ticks = clock();
+    vector<TitleKey> view = sortedView(input);
+    ticks = clock() - ticks;
+    cout << "  sortedView: " << (double)ticks / CLOCKS_PER_SEC << " seconds" << endl;
+
+    // Neighbours whose first 8 bytes tie but titles differ
+    size_t ties = 0;
+    for (size_t i = 1; i < view.size(); ++i) {
+        const string& title = input[view[i].index].title;
+        const string& previous = input[view[i - 1].index].title;
+        if (title != previous && titlePrefix(title, 0) == titlePrefix(previous, 0)) {
+            ++ties;
+        }
+    }
+    cout << "  different titles with the same 8 byte prefix: " << ties << " of " << view.size() << endl;
+
+    timeSort("indirectSort", input, [](vector<Bid>& v) {
+        indirectSort(v);
+    });
+}
+
+/**
+ * Compare sorting by fund, amount descending and bid id through a
+ * compile-time order with the same comparison called through
+ * std::function, which the compiler cannot inline
+ *
+ * @param bids The loaded bids, repeated up to BENCHMARK_SIZE
+ */
+void benchmarkSortOrder(const vector<Bid>& bids) {
+    if (bids.empty()) {
+        cout << "Load bids first" << endl;
+        return;
+    }
+    vector<Bid> input = repeatBids(bids, BENCHMARK_SIZE);
+    cout << input.size() << " bids by fund, amount descending, bid id:" << endl;
+
+    timeSort<ByFundAmountId>("introSort<ByFundAmountId>", input, [](vector<Bid>& v) {
+        introSort<ByFundAmountId>(v);
+    });
+    timeSort<ByFundAmountId>("std::sort, ByFundAmountId", input, [](vector<Bid>& v) {
+        sort(v.begin(), v.end(), ByFundAmountId());
+    });
+
+    // The same keys written out by hand behind a runtime comparator
+    function<bool(const Bid&, const Bid&)> compare = [](const Bid& a, const Bid& b) {
+        if (int order = a.fund.compare(b.fund)) {
+            return order < 0;
+        }
+        if (a.amount != b.amount) {
+            return a.amount > b.amount;
+        }
+        return a.bidId < b.bidId;
+    };
+    timeSort<ByFundAmountId>("std::sort, std::function", input, [&compare](vector<Bid>& v) {
+        sort(v.begin(), v.end(), compare);
+    });
+}
+
+/**
+ * Benchmark menu
+ *
+ * @param bids The loaded bids
+ */
+void runBenchmarks(const vector<Bid>& bids) {
+    cout << "Benchmarks:" << endl;
+    cout << "  1. Sort Algorithms" << endl;
+    cout << "  2. Parallel Sort" << endl;
+    cout << "  3. Indirect Sort" << endl;
+    cout << "  4. Multi-key Sort Order" << endl;
+    cout << "Enter choice: ";
+
+    int choice = 0;
+    cin >> choice;
+
+    switch (choice) {
+    case 1:
+        benchmarkSorts(bids);
+        break;
+
+    case 2:
+        benchmarkParallelSort(bids);
+        break;
+
+    case 3:
+        benchmarkIndirectSort(bids);
+        break;
+
+    case 4:
+        benchmarkSortOrder(bids);
+        break;
+    }
+}
+
+/**
+ * Sort a bid file on disk under a memory budget entered by the user
+ * and report the throughput
+ *
+ * @param inputPath CSV file to sort
+ * @param outputPath Sorted CSV file to write
+ */
+void externalSortFile(const string& inputPath, const string& outputPath) {
+    cout << "Enter memory budget in MB (0 for " << (EXTERNAL_SORT_BUDGET >> 20) << "): ";
+    size_t budget = 0;
+    cin >> budget;
+    budget = budget > 0 ? budget << 20 : EXTERNAL_SORT_BUDGET;
+
+    try {
+        ExternalSortStats stats = externalSort(inputPath, outputPath, budget);
+        double megabytes = stats.bytes / 1048576.0;
+        double seconds = stats.runSeconds + stats.mergeSeconds;
+        cout << stats.rows << " rows sorted into " << outputPath << " through " << stats.runs << " runs" << endl;
+        cout << "runs: " << stats.runSeconds << " seconds | merge: " << stats.mergeSeconds << " seconds" << endl;
+        cout << "throughput: " << (seconds > 0 ? megabytes / seconds : 0.0) << " MB/s" << endl;
+    }
+    catch (runtime_error& e) {
+        cerr << e.what() << endl;
+    }
+}
+
 /**
  * The one and only main() method
  */
@@ -200,15 +1463,23 @@ int main(int argc, char* argv[]) {
 
     // Define a timer variable
     clock_t startTicks, endTicks;
+    chrono::steady_clock::time_point wallStart;
 
     int choice = 0;
-    while (choice != 9) {
+    while (choice != 12) {
         cout << "Menu:" << endl;
         cout << "  1. Load Bids" << endl;
         cout << "  2. Display All Bids" << endl;
         cout << "  3. Selection Sort All Bids" << endl;
         cout << "  4. Quick Sort All Bids" << endl;
-        cout << "  9. Exit" << endl;
+        cout << "  5. Intro Sort All Bids" << endl;
+        cout << "  6. Parallel Sort All Bids" << endl;
+        cout << "  7. Run Benchmarks" << endl;
+        cout << "  8. String Sort All Bids" << endl;
+        cout << "  9. Indirect Sort All Bids" << endl;
+        cout << "  10. External Sort Bid File" << endl;
+        cout << "  11. Sort All Bids By Fund, Amount, Id" << endl;
+        cout << "  12. Exit" << endl;
         cout << "Enter choice: ";
         cin >> choice;
 
@@ -260,6 +1531,15 @@ int main(int argc, char* argv[]) {
             break;
 
         case 4:
+            // The Lomuto partition recurses once per bid on titles already
+            // in order either way or all equal, so like the benchmark skip
+            // large inputs of that shape rather than overflow the stack
+            if (bids.size() > QUADRATIC_SORT_MAX && (is_sorted(bids.begin(), bids.end(), ByTitle())
+                || is_sorted(bids.rbegin(), bids.rend(), ByTitle()))) {
+                cout << "Titles already in order, quick sort would recurse too deep. Use Intro Sort." << endl;
+                break;
+            }
+
             // Start the timer before sorting
             startTicks = clock();
 
@@ -277,6 +1557,103 @@ int main(int argc, char* argv[]) {
 
             break;
 
+        case 5:
+            // Start the timer before sorting
+            startTicks = clock();
+
+            // Perform intro sort
+            introSort(bids);
+
+            // Stop the timer after sorting
+            endTicks = clock();
+
+            cout << bids.size() << " bids sorted" << endl;
+
+            // Calculate elapsed time and display result
+            cout << "time: " << (endTicks - startTicks) << " clock ticks" << endl;
+            cout << "time: " << (double)(endTicks - startTicks) / CLOCKS_PER_SEC << " seconds" << endl;
+
+            break;
+
+        case 6:
+            // Time on the wall clock, clock() adds up every thread
+            wallStart = chrono::steady_clock::now();
+
+            // Perform parallel sort on every core
+            parallelSort(bids, max(thread::hardware_concurrency(), 1u));
+
+            cout << bids.size() << " bids sorted" << endl;
+
+            // Calculate elapsed time and display result
+            cout << "time: " << chrono::duration<double>(chrono::steady_clock::now() - wallStart).count()
+                << " seconds" << endl;
+
+            break;
+
+        case 7:
+            runBenchmarks(bids);
+
+            break;
+
+        case 8:
+            // Start the timer before sorting
+            startTicks = clock();
+
+            // Perform multikey quick sort on the title characters
+            multikeyQuickSort(bids);
+
+            // Stop the timer after sorting
+            endTicks = clock();
+
+            cout << bids.size() << " bids sorted" << endl;
+
+            // Calculate elapsed time and display result
+            cout << "time: " << (endTicks - startTicks) << " clock ticks" << endl;
+            cout << "time: " << (double)(endTicks - startTicks) / CLOCKS_PER_SEC << " seconds" << endl;
+
+            break;
+
+        case 9:
+            // Start the timer before sorting
+            startTicks = clock();
+
+            // Perform indirect sort on title prefixes, then move the bids
+            indirectSort(bids);
+
+            // Stop the timer after sorting
+            endTicks = clock();
+
+            cout << bids.size() << " bids sorted" << endl;
+
+            // Calculate elapsed time and display result
+            cout << "time: " << (endTicks - startTicks) << " clock ticks" << endl;
+            cout << "time: " << (double)(endTicks - startTicks) / CLOCKS_PER_SEC << " seconds" << endl;
+
+            break;
+
+        case 10:
+            externalSortFile(csvPath, csvPath + ".sorted.csv");
+
+            break;
+
+        case 11:
+            // Start the timer before sorting
+            startTicks = clock();
+
+            // Perform introsort by fund, largest amount first, then bid id
+            introSort<ByFundAmountId>(bids);
+
+            // Stop the timer after sorting
+            endTicks = clock();
+
+            cout << bids.size() << " bids sorted" << endl;
+
+            // Calculate elapsed time and display result
+            cout << "time: " << (endTicks - startTicks) << " clock ticks" << endl;
+            cout << "time: " << (double)(endTicks - startTicks) / CLOCKS_PER_SEC << " seconds" << endl;
+
+            break;
+
         }
     }
 